@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -15,21 +15,44 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 控件性能计数（绘制耗时、动画次数、帧回调），见 animation_core/perfcounters.h
+#DEFINES += WIDGET_PERF_COUNTERS
+
+# 输出 Chrome/Perfetto 时间线（绘制、动画、帧回调），见 animation_core/tracerecorder.h
+#DEFINES += WIDGET_TRACING
+
 INCLUDEPATH += \
+    animation_core/ \
     labeled_edit/ \
     interactive_buttons/
 
 SOURCES += \
+    animation_core/animationclock.cpp \
+    animation_core/framescheduler.cpp \
+    animation_core/perfcounters.cpp \
+    animation_core/tracerecorder.cpp \
     interactive_buttons/interactivebuttonbase.cpp \
+    interactive_buttons/tintedpixmapcache.cpp \
     labeled_edit/bottomlineedit.cpp \
     labeled_edit/labelededit.cpp \
+    labeled_edit/labelededitform.cpp \
+    labeled_edit/validation.cpp \
+    labeled_edit/validationrule.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
+    animation_core/animationclock.h \
+    animation_core/framescheduler.h \
+    animation_core/perfcounters.h \
+    animation_core/tracerecorder.h \
     interactive_buttons/interactivebuttonbase.h \
+    interactive_buttons/tintedpixmapcache.h \
     labeled_edit/bottomlineedit.h \
     labeled_edit/labelededit.h \
+    labeled_edit/labelededitform.h \
+    labeled_edit/validation.h \
+    labeled_edit/validationrule.h \
     mainwindow.h
 
 FORMS += \
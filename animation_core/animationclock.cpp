@@ -0,0 +1,99 @@
+#include "animationclock.h"
+#include <QElapsedTimer>
+
+static AnimationClock::Mode clock_mode = AnimationClock::Monotonic;
+static qint64 manual_time = 0;
+static std::function<qint64()> custom_source;
+
+/**
+ * 获取当前的动画时间
+ * @return 毫秒
+ */
+qint64 AnimationClock::now()
+{
+    switch (clock_mode)
+    {
+    case Manual:
+        return manual_time;
+    case Custom:
+        return custom_source();
+    default:
+        return monotonicNow();
+    }
+}
+
+AnimationClock::Mode AnimationClock::mode()
+{
+    return clock_mode;
+}
+
+/**
+ * 恢复默认的单调时钟
+ */
+void AnimationClock::setMonotonic()
+{
+    clock_mode = Monotonic;
+    custom_source = nullptr;
+}
+
+/**
+ * 开启/关闭虚拟时间
+ * 开启时从当前时间开始，避免时间戳倒退
+ */
+void AnimationClock::setManual(bool manual)
+{
+    if (!manual)
+    {
+        setMonotonic();
+        return ;
+    }
+    if (clock_mode != Manual)
+        manual_time = now();
+    clock_mode = Manual;
+}
+
+/**
+ * 使用外部的时间源（例如与应用自己的时间线同步）
+ * 传入空函数则恢复单调时钟
+ */
+void AnimationClock::setSource(std::function<qint64 ()> source)
+{
+    if (!source)
+    {
+        setMonotonic();
+        return ;
+    }
+    custom_source = source;
+    clock_mode = Custom;
+}
+
+/**
+ * 设置虚拟时间（仅手动模式）
+ */
+void AnimationClock::setTime(qint64 ms)
+{
+    manual_time = ms;
+}
+
+/**
+ * 虚拟时间前进（仅手动模式）
+ */
+void AnimationClock::advance(qint64 ms)
+{
+    manual_time += ms;
+}
+
+/**
+ * 单调时钟：从系统参考时间开始的毫秒数，不会是0
+ * （部分动画使用0表示“没有时间戳”）
+ */
+qint64 AnimationClock::monotonicNow()
+{
+    // 静态局部变量的初始化是线程安全的，其他线程第一次调用时不会重复 start()
+    static const QElapsedTimer timer = []{
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer.msecsSinceReference() + timer.elapsed();
+}
@@ -0,0 +1,36 @@
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include <QtGlobal>
+#include <functional>
+
+/**
+ * 所有动画共用的时钟（毫秒）
+ * 默认使用单调时钟，不受系统时间、时区、夏令时调整的影响
+ * 手动模式下时间只在调用 advance/setTime 时前进，用于测试与性能测试逐帧推进动画
+ */
+class AnimationClock
+{
+public:
+    enum Mode
+    {
+        Monotonic, // 单调时钟（默认）
+        Manual,    // 虚拟时间，手动推进
+        Custom     // 外部提供的时间源
+    };
+
+    static qint64 now();
+    static Mode mode();
+
+    static void setMonotonic();
+    static void setManual(bool manual = true);
+    static void setSource(std::function<qint64()> source);
+
+    static void setTime(qint64 ms);
+    static void advance(qint64 ms);
+
+private:
+    static qint64 monotonicNow();
+};
+
+#endif // ANIMATIONCLOCK_H
@@ -0,0 +1,170 @@
+#include "framescheduler.h"
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
+
+QPointer<FrameScheduler> FrameScheduler::scheduler;
+
+/**
+ * 销毁时自动取消订阅，控件不需要自己处理
+ */
+FrameClient::~FrameClient()
+{
+    if (frame_slot >= 0 && FrameScheduler::scheduler)
+        FrameScheduler::scheduler->unsubscribe(this);
+}
+
+/**
+ * 获取全局调度器，第一次调用时创建
+ * 跟随 QCoreApplication 一起销毁
+ */
+FrameScheduler *FrameScheduler::instance()
+{
+    if (scheduler.isNull())
+        scheduler = new FrameScheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+/**
+ * 控件当前是否能被看到
+ * 隐藏、所在窗口最小化、被完全遮挡（平台支持时）都不需要继续动画
+ */
+bool FrameScheduler::isExposed(const QWidget *widget)
+{
+    if (!widget->isVisible())
+        return false;
+    const QWidget* top = widget->window();
+    if (top->isMinimized())
+        return false;
+    QWindow* handle = top->windowHandle();
+    return handle && handle->isExposed();
+}
+
+FrameScheduler::FrameScheduler(QObject *parent) : QObject(parent)
+{
+    // 按主屏幕的刷新率运行，获取不到时使用60帧
+    int interval = 16;
+    QScreen* screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 1)
+        interval = qMax(1, qRound(1000.0 / screen->refreshRate()));
+
+    timer = new QTimer(this);
+    timer->setInterval(interval);
+    connect(timer, &QTimer::timeout, this, &FrameScheduler::tick);
+}
+
+/**
+ * 订阅帧时钟，已经订阅的不会重复
+ */
+void FrameScheduler::subscribe(FrameClient *client)
+{
+    if (client->frame_slot >= 0)
+        return ;
+    client->frame_slot = clients.size();
+    clients.append(client);
+    if (auto_tick && !timer->isActive())
+        timer->start();
+}
+
+/**
+ * 取消订阅
+ * 在帧回调中调用也是安全的
+ */
+void FrameScheduler::unsubscribe(FrameClient *client)
+{
+    int slot = client->frame_slot;
+    if (slot < 0)
+        return ;
+    client->frame_slot = -1;
+
+    if (tick_depth > 0) // 遍历结束后再整理
+    {
+        clients[slot] = nullptr;
+        removed_count++;
+        return ;
+    }
+
+    // 用最后一个填补空位
+    FrameClient* last = clients.takeLast();
+    if (last != client)
+    {
+        clients[slot] = last;
+        last->frame_slot = slot;
+    }
+    if (clients.isEmpty())
+        timer->stop();
+}
+
+int FrameScheduler::clientCount() const
+{
+    return clients.size() - removed_count;
+}
+
+int FrameScheduler::interval() const
+{
+    return timer->interval();
+}
+
+/**
+ * 是否由定时器自动产生每一帧
+ * 测试时可以关闭，配合 AnimationClock 的虚拟时间手动调用 tick()
+ */
+void FrameScheduler::setAutoTick(bool enable)
+{
+    auto_tick = enable;
+    if (!enable)
+        timer->stop();
+    else if (clientCount() > 0)
+        timer->start();
+}
+
+/**
+ * 一帧：依次通知所有订阅者
+ * 回调中新订阅的从下一帧开始
+ * 回调中进入嵌套的事件循环（例如 QDialog::exec）时会再次进入；
+ * 遍历中列表只会追加、不会缩短，最外层结束后才整理空位
+ */
+void FrameScheduler::tick()
+{
+    frame_count++;
+    tick_depth++;
+    const int count = clients.size();
+    for (int i = 0; i < count; i++)
+    {
+        FrameClient* client = clients.at(i);
+        if (client)
+            client->frameTick();
+    }
+    if (--tick_depth > 0)
+    {
+        emit frameFinished();
+        return ;
+    }
+
+    if (removed_count)
+        compact();
+    if (clients.isEmpty())
+        timer->stop();
+
+    emit frameFinished();
+}
+
+/**
+ * 去掉遍历中取消订阅留下的空位
+ */
+void FrameScheduler::compact()
+{
+    int j = 0;
+    for (int i = 0; i < clients.size(); i++)
+    {
+        FrameClient* client = clients.at(i);
+        if (!client)
+            continue;
+        client->frame_slot = j;
+        clients[j++] = client;
+    }
+    clients.resize(j);
+    removed_count = 0;
+}
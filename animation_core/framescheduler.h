@@ -0,0 +1,71 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QPointer>
+
+class FrameScheduler;
+class QWidget;
+
+/**
+ * 需要逐帧刷新的控件
+ * 动画开始时订阅，结束后取消订阅
+ */
+class FrameClient
+{
+    friend class FrameScheduler;
+public:
+    virtual ~FrameClient();
+    virtual void frameTick() = 0;
+
+private:
+    int frame_slot = -1; // 在调度器中的位置，-1表示未订阅
+};
+
+/**
+ * 全局共享的帧时钟
+ * 所有动画中的控件共用一个按屏幕刷新率运行的定时器，每帧只唤醒一次
+ * 没有订阅者时自动停止
+ */
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+    friend class FrameClient;
+public:
+    static FrameScheduler* instance();
+    static bool isExposed(const QWidget* widget);
+
+    void subscribe(FrameClient* client);
+    void unsubscribe(FrameClient* client);
+    bool isSubscribed(const FrameClient* client) const { return client->frame_slot >= 0; }
+    int clientCount() const;
+
+    int interval() const;
+    quint64 frameCount() const { return frame_count; }
+
+    void setAutoTick(bool enable);
+    bool isAutoTick() const { return auto_tick; }
+
+signals:
+    void frameFinished(); // 一帧中所有订阅者都处理完毕
+
+public slots:
+    void tick();
+
+private:
+    FrameScheduler(QObject* parent = nullptr);
+    void compact();
+
+private:
+    static QPointer<FrameScheduler> scheduler;
+    QTimer* timer;
+    QVector<FrameClient*> clients;
+    bool auto_tick = true;     // 关闭后只能手动调用 tick()（配合虚拟时间逐帧推进）
+    int tick_depth = 0;        // 正在遍历订阅者的层数（回调中打开模态对话框会嵌套），大于0时取消订阅只置空
+    int removed_count = 0;     // 遍历中被置空的数量
+    quint64 frame_count = 0;
+};
+
+#endif // FRAMESCHEDULER_H
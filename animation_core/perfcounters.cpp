@@ -0,0 +1,120 @@
+#include "perfcounters.h"
+
+#ifdef WIDGET_PERF_COUNTERS
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+
+QPointer<PerfRegistry> PerfRegistry::registry;
+QVector<PerfCounters*> PerfRegistry::counters;
+
+PerfCounters::PerfCounters(QObject *owner) : owner(owner)
+{
+    PerfRegistry::counters.append(this);
+}
+
+PerfCounters::~PerfCounters()
+{
+    PerfRegistry::counters.removeOne(this);
+}
+
+void PerfCounters::recordPaint(qint64 nsecs)
+{
+    paints++;
+    paint_nsecs_total += nsecs;
+    if (nsecs > paint_nsecs_max)
+        paint_nsecs_max = nsecs;
+}
+
+void PerfCounters::recordAnimation(bool retarget)
+{
+    if (retarget)
+        animations_retargeted++;
+    else
+        animations_started++;
+}
+
+void PerfCounters::recordTick(bool changed)
+{
+    ticks++;
+    if (!changed)
+        wasted_ticks++;
+}
+
+void PerfCounters::reset()
+{
+    paints = 0;
+    paint_nsecs_total = paint_nsecs_max = 0;
+    animations_started = animations_retargeted = 0;
+    ticks = wasted_ticks = 0;
+}
+
+/**
+ * 时间单位为毫秒
+ */
+QJsonObject PerfCounters::toJson() const
+{
+    QJsonObject obj;
+    obj["class"] = owner->metaObject()->className();
+    obj["name"] = owner->objectName();
+    obj["address"] = QString("0x%1").arg(reinterpret_cast<quintptr>(owner), 0, 16);
+    obj["paints"] = static_cast<double>(paints);
+    obj["paint_ms_total"] = paint_nsecs_total / 1e6;
+    obj["paint_ms_max"] = paint_nsecs_max / 1e6;
+    obj["animations_started"] = static_cast<double>(animations_started);
+    obj["animations_retargeted"] = static_cast<double>(animations_retargeted);
+    obj["ticks"] = static_cast<double>(ticks);
+    obj["wasted_ticks"] = static_cast<double>(wasted_ticks);
+    return obj;
+}
+
+/**
+ * 获取全局计数器表，第一次调用时创建
+ * 跟随 QCoreApplication 一起销毁
+ */
+PerfRegistry *PerfRegistry::instance()
+{
+    if (registry.isNull())
+        registry = new PerfRegistry(QCoreApplication::instance());
+    return registry;
+}
+
+PerfRegistry::PerfRegistry(QObject *parent) : QObject(parent)
+{
+}
+
+/**
+ * 所有存活控件当前的计数
+ */
+QJsonArray PerfRegistry::snapshot() const
+{
+    QJsonArray array;
+    for (const PerfCounters* c : counters)
+        array.append(c->toJson());
+    return array;
+}
+
+QByteArray PerfRegistry::snapshotJson(bool compact) const
+{
+    return QJsonDocument(snapshot()).toJson(compact ? QJsonDocument::Compact : QJsonDocument::Indented);
+}
+
+/**
+ * 通过信号发出当前的计数
+ * 可以连接到定时器上定期输出
+ */
+void PerfRegistry::publish()
+{
+    emit snapshotPublished(snapshot());
+}
+
+/**
+ * 所有控件的计数清零
+ */
+void PerfRegistry::reset()
+{
+    for (PerfCounters* c : counters)
+        c->reset();
+}
+
+#endif // WIDGET_PERF_COUNTERS
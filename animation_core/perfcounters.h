@@ -0,0 +1,105 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+/**
+ * 控件性能计数（绘制、动画、帧回调）
+ * 只有定义了 WIDGET_PERF_COUNTERS 才会编译进来，否则下面的宏全部为空
+ * 在 .pro 中添加：DEFINES += WIDGET_PERF_COUNTERS
+ */
+#ifdef WIDGET_PERF_COUNTERS
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+
+/**
+ * 单个控件的计数器，作为控件的成员
+ * 构造时注册到全局表，析构时自动移除
+ */
+class PerfCounters
+{
+public:
+    PerfCounters(QObject* owner);
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    void recordPaint(qint64 nsecs);
+    void recordAnimation(bool retarget);
+    void recordTick(bool changed);
+    void reset();
+
+    QJsonObject toJson() const;
+
+public:
+    quint64 paints = 0;
+    qint64 paint_nsecs_total = 0;
+    qint64 paint_nsecs_max = 0;
+    quint64 animations_started = 0;    // 从静止开始的动画
+    quint64 animations_retargeted = 0; // 动画进行中修改了终点
+    quint64 ticks = 0;                 // 帧回调次数
+    quint64 wasted_ticks = 0;          // 帧回调中什么都没有改变
+
+private:
+    QObject* owner;
+};
+
+/**
+ * 所有存活控件的计数器表
+ */
+class PerfRegistry : public QObject
+{
+    Q_OBJECT
+    friend class PerfCounters;
+public:
+    static PerfRegistry* instance();
+
+    QJsonArray snapshot() const;
+    QByteArray snapshotJson(bool compact = false) const;
+    int count() const { return counters.size(); }
+
+signals:
+    void snapshotPublished(const QJsonArray& counters);
+
+public slots:
+    void publish();
+    void reset();
+
+private:
+    PerfRegistry(QObject* parent = nullptr);
+
+private:
+    static QPointer<PerfRegistry> registry;
+    static QVector<PerfCounters*> counters; // 与 registry 分开，控件可能在 QApplication 之前/之后构造与销毁
+};
+
+/**
+ * 统计一次绘制的耗时，离开作用域时记录
+ */
+class PerfPaintScope
+{
+public:
+    PerfPaintScope(PerfCounters& counters) : counters(counters) { timer.start(); }
+    ~PerfPaintScope() { counters.recordPaint(timer.nsecsElapsed()); }
+
+private:
+    PerfCounters& counters;
+    QElapsedTimer timer;
+};
+
+#define PERF_PAINT_SCOPE(c) PerfPaintScope _perf_paint_scope(c)
+#define PERF_ANIMATION(c, retarget) (c).recordAnimation(retarget)
+#define PERF_TICK(c, changed) (c).recordTick(changed)
+
+#else
+
+#define PERF_PAINT_SCOPE(c)
+#define PERF_ANIMATION(c, retarget)
+#define PERF_TICK(c, changed)
+
+#endif // WIDGET_PERF_COUNTERS
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,190 @@
+#include "tracerecorder.h"
+
+#ifdef WIDGET_TRACING
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <QCoreApplication>
+
+std::atomic<bool> TraceRecorder::recording(false);
+QMutex TraceRecorder::mutex;
+QVector<TraceRecorder::Event> TraceRecorder::ring;
+int TraceRecorder::head = 0;
+int TraceRecorder::count = 0;
+
+/**
+ * 开始记录，清空之前的内容
+ * @param capacity 最多保留的事件数量
+ */
+void TraceRecorder::start(int capacity)
+{
+    QMutexLocker locker(&mutex);
+    ring.clear();
+    ring.resize(qMax(1, capacity));
+    head = count = 0;
+    recording = true;
+}
+
+/**
+ * 停止记录，已记录的内容保留到 flush/clear
+ */
+void TraceRecorder::stop()
+{
+    recording = false;
+}
+
+/**
+ * 单调时钟（微秒），与 AnimationClock 的虚拟时间无关
+ */
+qint64 TraceRecorder::timestamp()
+{
+    // 校验线程中也会调用，静态局部变量的初始化是线程安全的
+    static const QElapsedTimer timer = []{
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::complete(const char *cat, const char *name, qint64 ts, qint64 dur)
+{
+    Event event;
+    event.cat = cat;
+    event.name = name;
+    event.phase = 'X';
+    event.ts = ts;
+    event.dur = dur;
+    append(event);
+}
+
+void TraceRecorder::asyncBegin(const char *cat, const char *name, quintptr id)
+{
+    Event event;
+    event.cat = cat;
+    event.name = name;
+    event.phase = 'b';
+    event.ts = timestamp();
+    event.id = id;
+    append(event);
+}
+
+void TraceRecorder::asyncEnd(const char *cat, const char *name, quintptr id)
+{
+    Event event;
+    event.cat = cat;
+    event.name = name;
+    event.phase = 'e';
+    event.ts = timestamp();
+    event.id = id;
+    append(event);
+}
+
+void TraceRecorder::instant(const char *cat, const char *name)
+{
+    Event event;
+    event.cat = cat;
+    event.name = name;
+    event.phase = 'i';
+    event.ts = timestamp();
+    append(event);
+}
+
+void TraceRecorder::append(const Event &event)
+{
+    QMutexLocker locker(&mutex);
+    if (!recording || ring.isEmpty())
+        return ;
+    Event& slot = ring[head];
+    slot = event;
+    slot.tid = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    head = (head + 1) % ring.size();
+    if (count < ring.size())
+        count++;
+}
+
+/**
+ * 输出带引号的 JSON 字符串，转义引号、反斜杠和控制字符
+ * 事件名可能来自应用自己的 TRACE_SCOPE，不能假设不含这些字符
+ */
+static void appendJsonString(QByteArray& json, const char* s)
+{
+    json += '"';
+    for (const char* p = s ? s : ""; *p; p++)
+    {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+        {
+            json += '\\';
+            json += static_cast<char>(c);
+        }
+        else if (c < 0x20)
+        {
+            char buf[8];
+            qsnprintf(buf, sizeof(buf), "\\u%04x", c);
+            json += buf;
+        }
+        else
+            json += static_cast<char>(c);
+    }
+    json += '"';
+}
+
+/**
+ * 按时间顺序输出缓冲区中的事件（Trace Event Format）
+ */
+QByteArray TraceRecorder::toJson()
+{
+    QMutexLocker locker(&mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray json;
+    json.reserve(count * 96 + 32);
+    json += "{\"traceEvents\":[\n";
+    const int first = (head - count + ring.size()) % qMax(1, ring.size());
+    for (int i = 0; i < count; i++)
+    {
+        const Event& e = ring.at((first + i) % ring.size());
+        if (i)
+            json += ",\n";
+        json += "{\"name\":";
+        appendJsonString(json, e.name);
+        json += ",\"cat\":";
+        appendJsonString(json, e.cat);
+        json += ",\"ph\":\"";
+        json += e.phase;
+        json += "\",\"ts\":" + QByteArray::number(e.ts);
+        if (e.phase == 'X')
+            json += ",\"dur\":" + QByteArray::number(e.dur);
+        else if (e.phase == 'i')
+            json += ",\"s\":\"t\"";
+        else
+            json += ",\"id\":\"0x" + QByteArray::number(static_cast<qulonglong>(e.id), 16) + "\"";
+        json += ",\"pid\":" + QByteArray::number(pid);
+        json += ",\"tid\":" + QByteArray::number(static_cast<qulonglong>(e.tid));
+        json += "}";
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+/**
+ * 写入文件并清空缓冲区，继续记录
+ */
+bool TraceRecorder::flush(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(toJson());
+    clear();
+    return true;
+}
+
+void TraceRecorder::clear()
+{
+    QMutexLocker locker(&mutex);
+    head = count = 0;
+}
+
+#endif // WIDGET_TRACING
@@ -0,0 +1,97 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+/**
+ * Chrome/Perfetto 格式的时间线记录（chrome://tracing、ui.perfetto.dev 打开）
+ * 只有定义了 WIDGET_TRACING 才会编译进来，否则下面的宏全部为空
+ * 在 .pro 中添加：DEFINES += WIDGET_TRACING
+ *
+ * 用法：
+ *   TraceRecorder::start();
+ *   ...
+ *   TraceRecorder::flush("trace.json");
+ * 应用自己的代码也可以使用 TRACE_SCOPE，和控件的事件显示在同一条时间线上
+ */
+#ifdef WIDGET_TRACING
+
+#include <QtGlobal>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <atomic>
+
+class TraceRecorder
+{
+public:
+    struct Event
+    {
+        const char* name = nullptr; // 都是字符串常量，记录时不复制
+        const char* cat = nullptr;
+        char phase = 'X';           // X: 完整区间，b/e: 异步开始/结束，i: 瞬间
+        qint64 ts = 0;              // 微秒
+        qint64 dur = 0;
+        quintptr id = 0;            // 异步事件的配对标识，同一对象的多个通道要各不相同
+        quintptr tid = 0;
+    };
+
+    static void start(int capacity = 65536);
+    static void stop();
+    static bool isRecording() { return recording; }
+    static qint64 timestamp();
+
+    static void complete(const char* cat, const char* name, qint64 ts, qint64 dur);
+    static void asyncBegin(const char* cat, const char* name, quintptr id);
+    static void asyncEnd(const char* cat, const char* name, quintptr id);
+    static void instant(const char* cat, const char* name);
+
+    static QByteArray toJson();
+    static bool flush(const QString& path);
+    static void clear();
+
+private:
+    static void append(const Event& event);
+
+private:
+    static std::atomic<bool> recording; // 绘制线程之外（如校验线程）也会读取
+    static QMutex mutex;
+    static QVector<Event> ring; // 环形缓冲区，满了覆盖最旧的事件
+    static int head;            // 下一个写入的位置
+    static int count;
+};
+
+/**
+ * 作用域内的耗时区间
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* cat, const char* name)
+        : cat(cat), name(name), ts(TraceRecorder::isRecording() ? TraceRecorder::timestamp() : -1) {}
+    ~TraceScope()
+    {
+        if (ts >= 0 && TraceRecorder::isRecording())
+            TraceRecorder::complete(cat, name, ts, TraceRecorder::timestamp() - ts);
+    }
+
+private:
+    const char* cat;
+    const char* name;
+    qint64 ts;
+};
+
+#define TRACE_SCOPE(cat, name) TraceScope _trace_scope(cat, name)
+#define TRACE_ASYNC_BEGIN(cat, name, id) do { if (TraceRecorder::isRecording()) TraceRecorder::asyncBegin(cat, name, id); } while (0)
+#define TRACE_ASYNC_END(cat, name, id) do { if (TraceRecorder::isRecording()) TraceRecorder::asyncEnd(cat, name, id); } while (0)
+#define TRACE_INSTANT(cat, name) do { if (TraceRecorder::isRecording()) TraceRecorder::instant(cat, name); } while (0)
+
+#else
+
+#define TRACE_SCOPE(cat, name)
+#define TRACE_ASYNC_BEGIN(cat, name, id)
+#define TRACE_ASYNC_END(cat, name, id)
+#define TRACE_INSTANT(cat, name)
+
+#endif // WIDGET_TRACING
+
+#endif // TRACERECORDER_H
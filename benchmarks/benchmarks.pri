@@ -0,0 +1,40 @@
+# 性能测试共用的控件源码
+# 运行时默认使用 offscreen 平台，不需要显示器
+
+QT       += core gui widgets concurrent testlib
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+SOURCE_ROOT = $$PWD/..
+
+INCLUDEPATH += \
+    $$SOURCE_ROOT/animation_core/ \
+    $$SOURCE_ROOT/labeled_edit/ \
+    $$SOURCE_ROOT/interactive_buttons/
+
+SOURCES += \
+    $$SOURCE_ROOT/animation_core/animationclock.cpp \
+    $$SOURCE_ROOT/animation_core/framescheduler.cpp \
+    $$SOURCE_ROOT/animation_core/perfcounters.cpp \
+    $$SOURCE_ROOT/animation_core/tracerecorder.cpp \
+    $$SOURCE_ROOT/interactive_buttons/interactivebuttonbase.cpp \
+    $$SOURCE_ROOT/interactive_buttons/tintedpixmapcache.cpp \
+    $$SOURCE_ROOT/labeled_edit/bottomlineedit.cpp \
+    $$SOURCE_ROOT/labeled_edit/labelededit.cpp \
+    $$SOURCE_ROOT/labeled_edit/labelededitform.cpp \
+    $$SOURCE_ROOT/labeled_edit/validation.cpp \
+    $$SOURCE_ROOT/labeled_edit/validationrule.cpp
+
+HEADERS += \
+    $$SOURCE_ROOT/animation_core/animationclock.h \
+    $$SOURCE_ROOT/animation_core/framescheduler.h \
+    $$SOURCE_ROOT/animation_core/perfcounters.h \
+    $$SOURCE_ROOT/animation_core/tracerecorder.h \
+    $$SOURCE_ROOT/interactive_buttons/interactivebuttonbase.h \
+    $$SOURCE_ROOT/interactive_buttons/tintedpixmapcache.h \
+    $$SOURCE_ROOT/labeled_edit/bottomlineedit.h \
+    $$SOURCE_ROOT/labeled_edit/labelededit.h \
+    $$SOURCE_ROOT/labeled_edit/labelededitform.h \
+    $$SOURCE_ROOT/labeled_edit/validation.h \
+    $$SOURCE_ROOT/labeled_edit/validationrule.h
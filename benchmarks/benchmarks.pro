@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    interactivebutton \
+    labelededit_paint \
+    stress
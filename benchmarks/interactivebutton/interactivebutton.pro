@@ -0,0 +1,6 @@
+TARGET = tst_interactivebutton
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_interactivebutton.cpp
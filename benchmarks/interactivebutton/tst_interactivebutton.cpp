@@ -0,0 +1,342 @@
+#include <QtTest>
+#include <QApplication>
+#include <QStyle>
+#include <QImage>
+#include "interactivebuttonbase.h"
+
+/**
+ * 用于测试的按钮，可以直接设置动画中的状态
+ */
+class BenchButton : public InteractiveButtonBase
+{
+public:
+    BenchButton(QWidget* parent = nullptr) : InteractiveButtonBase(parent) {}
+
+    /**
+     * 添加水波纹：一部分正在扩散，每三个中有一个正在渐变消失
+     */
+    void addWaters(int count)
+    {
+        qint64 now = getTimestamp();
+        for (int i = 0; i < count; i++)
+        {
+            Water water(QPoint(width() * (i + 1) / (count + 1), height() / 2), now - i * 20);
+            water.progress = 10 + 80 * i / count;
+            if (i % 3 == 2)
+            {
+                water.release_timestamp = now;
+                water.finish_timestamp = now;
+                water.finished = true;
+            }
+            waters << water;
+        }
+    }
+
+    // 鼠标悬浮，锚点正在向鼠标移动
+    void armHover()
+    {
+        hovering = true;
+        hover_progress = 50;
+        anchor_pos = QPoint(width() / 2, height() / 2);
+        mouse_pos = QPoint(width() - 2, height() - 2);
+    }
+
+    // 鼠标按住，背景渐变与水波纹都在进行
+    void armPress()
+    {
+        hovering = pressing = true;
+        press_progress = 50;
+        if (waters.isEmpty())
+            addWaters(1);
+    }
+
+    // 松开后的抖动
+    void armJitter()
+    {
+        qint64 now = getTimestamp();
+        QPoint center(width() / 2, height() / 2);
+        jitters.clear();
+        jitters << Jitter(QPoint(width() - 2, height() - 2), now - 50)
+                << Jitter(center - QPoint(width() / 4, height() / 4), now + 100)
+                << Jitter(center, now + 300);
+    }
+
+    // 逐帧刷新中（使用分层缓存）
+    void armAnimating()
+    {
+        subscribeFrames();
+    }
+
+    void setHoverProgress(int progress)
+    {
+        hover_progress = progress;
+    }
+
+    // 前景出现动画
+    void armShow()
+    {
+        show_animation = show_foreground = true;
+        show_ani_appearing = true;
+        show_ani_progress = 0;
+        show_timestamp = getTimestamp() - 100;
+        show_ani_point = QPoint(width(), height());
+    }
+};
+
+/**
+ * InteractiveButtonBase 的绘制与定时刷新耗时
+ * 绘制：每种前景模型 × 水波纹数量 × 是否圆角
+ * 刷新：悬浮、按下、抖动、出现动画中的 anchorTimeOut
+ * 变色：切换主题时大量按钮同时修改图标颜色
+ * 悬浮渐变：每帧只有悬浮透明度改变，对比是否使用分层缓存
+ */
+class TestInteractiveButton : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void paint_data();
+    void paint();
+    void tick_data();
+    void tick();
+    void recolor_data();
+    void recolor();
+    void hoverFade_data();
+    void hoverFade();
+
+private:
+    void createButton(int model, int radius);
+
+    BenchButton* button = nullptr;
+};
+
+void TestInteractiveButton::initTestCase()
+{
+    AnimationClock::setManual();
+    FrameScheduler::instance()->setAutoTick(false);
+}
+
+void TestInteractiveButton::cleanupTestCase()
+{
+    FrameScheduler::instance()->setAutoTick(true);
+    AnimationClock::setManual(false);
+}
+
+void TestInteractiveButton::cleanup()
+{
+    delete button;
+    button = nullptr;
+}
+
+/**
+ * 创建对应前景模型的按钮
+ */
+void TestInteractiveButton::createButton(int model, int radius)
+{
+    QIcon icon = QApplication::style()->standardIcon(QStyle::SP_DialogOkButton);
+    QPixmap pixmap(32, 32);
+    pixmap.fill(Qt::transparent);
+    {
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setBrush(Qt::black);
+        painter.drawEllipse(pixmap.rect().adjusted(4, 4, -4, -4));
+    }
+
+    button = new BenchButton;
+    switch (model)
+    {
+    case InteractiveButtonBase::Text:
+        button->setText("确定");
+        break;
+    case InteractiveButtonBase::Icon:
+        button->setIcon(icon);
+        break;
+    case InteractiveButtonBase::PixmapMask:
+        button->setPixmap(pixmap);
+        break;
+    case InteractiveButtonBase::IconText:
+        button->setIcon(icon);
+        button->setText("确定");
+        break;
+    case InteractiveButtonBase::PixmapText:
+        button->setPixmap(pixmap);
+        button->setText("确定");
+        break;
+    }
+    button->setRadius(radius);
+    button->setBgColor(QColor(0xF2, 0xF2, 0xF2));
+    button->resize(120, 40);
+    button->show();
+    QCoreApplication::processEvents();
+}
+
+void TestInteractiveButton::paint_data()
+{
+    QTest::addColumn<int>("model");
+    QTest::addColumn<int>("waters");
+    QTest::addColumn<int>("radius");
+
+    const QList<QPair<int, QString>> models = {
+        { InteractiveButtonBase::Text, "Text" },
+        { InteractiveButtonBase::Icon, "Icon" },
+        { InteractiveButtonBase::PixmapMask, "PixmapMask" },
+        { InteractiveButtonBase::IconText, "IconText" },
+        { InteractiveButtonBase::PixmapText, "PixmapText" }
+    };
+    for (const QPair<int, QString>& model : models)
+        for (int waters : { 0, 1, 5, 20 })
+            for (int radius : { 0, 8 })
+                QTest::newRow(qPrintable(QString("%1_waters%2_radius%3").arg(model.second).arg(waters).arg(radius)))
+                        << model.first << waters << radius;
+}
+
+/**
+ * 悬浮中、带有若干水波纹的绘制
+ * 圆角时每个水波纹都要与背景求交集
+ */
+void TestInteractiveButton::paint()
+{
+    QFETCH(int, model);
+    QFETCH(int, waters);
+    QFETCH(int, radius);
+    createButton(model, radius);
+    button->armHover();
+    if (waters)
+        button->addWaters(waters);
+
+    const qreal dpr = button->devicePixelRatioF();
+    QImage image(button->size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+        button->render(&image);
+    }
+}
+
+void TestInteractiveButton::tick_data()
+{
+    QTest::addColumn<QString>("state");
+
+    QTest::newRow("hover") << "hover";
+    QTest::newRow("press") << "press";
+    QTest::newRow("jitter") << "jitter";
+    QTest::newRow("show") << "show";
+}
+
+/**
+ * 每次先恢复到动画中的状态，再推进一帧
+ */
+void TestInteractiveButton::tick()
+{
+    QFETCH(QString, state);
+    createButton(InteractiveButtonBase::PixmapText, 8);
+
+    QBENCHMARK {
+        if (state == "hover")
+            button->armHover();
+        else if (state == "press")
+            button->armPress();
+        else if (state == "jitter")
+            button->armJitter();
+        else if (state == "show")
+            button->armShow();
+        AnimationClock::advance(16);
+        button->anchorTimeOut();
+    }
+}
+
+void TestInteractiveButton::recolor_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("cold") << false;
+    QTest::newRow("cached") << true;
+}
+
+/**
+ * 200个使用同一图标的按钮，在两种主题颜色之间切换
+ * cold：每次清空着色缓存，相当于第一次切换到该颜色
+ */
+void TestInteractiveButton::recolor()
+{
+    QFETCH(bool, cached);
+    QPixmap pixmap(48, 48);
+    pixmap.fill(Qt::transparent);
+    {
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setBrush(Qt::black);
+        painter.drawEllipse(pixmap.rect().adjusted(4, 4, -4, -4));
+    }
+
+    QList<InteractiveButtonBase*> buttons;
+    for (int i = 0; i < 200; i++)
+        buttons.append(new InteractiveButtonBase(pixmap));
+
+    bool dark = false;
+    QBENCHMARK {
+        if (!cached)
+            TintedPixmapCache::clear();
+        dark = !dark;
+        for (InteractiveButtonBase* btn : buttons)
+            btn->setIconColor(dark ? QColor(0xE0, 0xE0, 0xE0) : QColor(0x20, 0x20, 0x20));
+    }
+    qDeleteAll(buttons);
+}
+
+void TestInteractiveButton::hoverFade_data()
+{
+    QTest::addColumn<int>("model");
+    QTest::addColumn<bool>("layers");
+
+    const QList<QPair<int, QString>> models = {
+        { InteractiveButtonBase::Text, "Text" },
+        { InteractiveButtonBase::Icon, "Icon" },
+        { InteractiveButtonBase::PixmapText, "PixmapText" }
+    };
+    for (const QPair<int, QString>& model : models)
+        for (bool layers : { false, true })
+            QTest::newRow(qPrintable(QString("%1_%2").arg(model.second).arg(layers ? "layers" : "direct")))
+                    << model.first << layers;
+}
+
+/**
+ * 圆角、有边框的按钮，悬浮渐变中的一帧
+ */
+void TestInteractiveButton::hoverFade()
+{
+    QFETCH(int, model);
+    QFETCH(bool, layers);
+    createButton(model, 8);
+    button->setBorderColor(QColor(0xCC, 0xCC, 0xCC));
+    button->setLayerCache(layers);
+    button->armHover();
+    button->armAnimating();
+
+    const qreal dpr = button->devicePixelRatioF();
+    QImage image(button->size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    int progress = 0;
+    QBENCHMARK {
+        progress = progress % 100 + 1;
+        button->setHoverProgress(progress);
+        image.fill(Qt::transparent);
+        button->render(&image);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认不需要显示器
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    TestInteractiveButton test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_interactivebutton.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_labelededit_paint
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_labelededit_paint.cpp
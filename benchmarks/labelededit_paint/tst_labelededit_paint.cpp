@@ -0,0 +1,280 @@
+#include <QtTest>
+#include <QApplication>
+#include <QImage>
+#include "labelededit.h"
+
+/**
+ * LabeledEdit 各种状态下 paintEvent 的耗时
+ * 使用虚拟时间把动画推进到指定的位置，然后重复绘制到 QImage
+ * 每种状态都分别测试长短标签（label_ani_max 两侧）与不同长度的输入内容
+ */
+class TestLabeledEditPaint : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void idle_data();
+    void idle();
+    void idleUncached_data();
+    void idleUncached();
+    void labelRise_data();
+    void labelRise();
+    void wrongWave_data();
+    void wrongWave();
+    void correct_data();
+    void correct();
+    void loading_data();
+    void loading();
+    void messageShow_data();
+    void messageShow();
+    void messageHide_data();
+    void messageHide();
+
+private:
+    void addRows(const QList<int>& elapsed_list);
+    void createEdit();
+    void advance(int ms);
+    void benchmarkRender();
+
+    LabeledEdit* edit = nullptr;
+};
+
+void TestLabeledEditPaint::initTestCase()
+{
+    // 动画只在手动推进时前进，每次运行的结果都一样
+    AnimationClock::setManual();
+    FrameScheduler::instance()->setAutoTick(false);
+}
+
+void TestLabeledEditPaint::cleanupTestCase()
+{
+    FrameScheduler::instance()->setAutoTick(true);
+    AnimationClock::setManual(false);
+}
+
+void TestLabeledEditPaint::cleanup()
+{
+    delete edit;
+    edit = nullptr;
+}
+
+/**
+ * 标签：2个字（整体动画）、9个字（逐字动画）
+ * 输入内容：空、短、长
+ */
+void TestLabeledEditPaint::addRows(const QList<int>& elapsed_list)
+{
+    QTest::addColumn<QString>("label");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("elapsed");
+
+    const QStringList labels = { "密码", "请输入您的用户名称" };
+    const QStringList texts = { "", "abc123", QString(200, 'x') };
+    for (const QString& label : labels)
+        for (const QString& text : texts)
+            for (int elapsed : elapsed_list)
+                QTest::newRow(qPrintable(QString("label%1_text%2_%3ms").arg(label.length()).arg(text.length()).arg(elapsed)))
+                        << label << text << elapsed;
+}
+
+/**
+ * 创建当前数据行对应的输入框，输入内容直接设置到编辑框（不触发标签动画）
+ */
+void TestLabeledEditPaint::createEdit()
+{
+    QFETCH(QString, label);
+    QFETCH(QString, text);
+
+    edit = new LabeledEdit(label);
+    edit->resize(320, 80);
+    edit->show();
+    QCoreApplication::processEvents(); // 构造时延迟调用的 adjustBlank
+    edit->adjustBlank();
+    edit->editor()->setText(text);
+}
+
+/**
+ * 按每帧16毫秒推进虚拟时间
+ */
+void TestLabeledEditPaint::advance(int ms)
+{
+    while (ms > 0)
+    {
+        int step = qMin(ms, 16);
+        AnimationClock::advance(step);
+        FrameScheduler::instance()->tick();
+        ms -= step;
+    }
+    QCoreApplication::processEvents();
+}
+
+void TestLabeledEditPaint::benchmarkRender()
+{
+    const qreal dpr = edit->devicePixelRatioF();
+    QImage image(edit->size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+        edit->render(&image);
+    }
+}
+
+void TestLabeledEditPaint::idle_data()
+{
+    addRows({ 0 });
+}
+
+/**
+ * 静止状态：没有内容时标签在里面，有内容时标签在上面
+ */
+void TestLabeledEditPaint::idle()
+{
+    createEdit();
+    if (!edit->text().isEmpty())
+        edit->setText(edit->text());
+    advance(2000);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::idleUncached_data()
+{
+    addRows({ 0 });
+}
+
+/**
+ * 静止状态，不使用缓存的图片，每次都逐字绘制标签
+ */
+void TestLabeledEditPaint::idleUncached()
+{
+    createEdit();
+    edit->setChromeCache(false);
+    if (!edit->text().isEmpty())
+        edit->setText(edit->text());
+    advance(2000);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::labelRise_data()
+{
+    addRows({ 50, 100, 200, 260 });
+}
+
+/**
+ * 获取焦点，标签上升到输入框上方的过程
+ */
+void TestLabeledEditPaint::labelRise()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    emit edit->editor()->signalFocusIn();
+    advance(elapsed);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::wrongWave_data()
+{
+    addRows({ 50, 200, 450, 800 });
+}
+
+/**
+ * 错误波浪线经过文字的过程
+ */
+void TestLabeledEditPaint::wrongWave()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    advance(1000);
+    edit->showWrong();
+    advance(elapsed);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::correct_data()
+{
+    addRows({ 100, 300, 480, 700 });
+}
+
+/**
+ * 正确的勾：下划线分割、弧线、勾的右半边、完整的勾
+ */
+void TestLabeledEditPaint::correct()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    advance(1000);
+    edit->showCorrect();
+    advance(elapsed);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::loading_data()
+{
+    addRows({ 150, 600, 2000 });
+}
+
+/**
+ * 加载中的菊花：出现中、稳定转动
+ */
+void TestLabeledEditPaint::loading()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    advance(1000);
+    edit->showLoading();
+    advance(elapsed);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::messageShow_data()
+{
+    addRows({ 1000, 1200, 2000 });
+}
+
+/**
+ * 错误信息从右边飞入，以及完全显示
+ * 波浪线结束（约900毫秒）后才开始显示
+ */
+void TestLabeledEditPaint::messageShow()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    advance(1000);
+    edit->showWrong("用户名已存在");
+    advance(elapsed);
+    benchmarkRender();
+}
+
+void TestLabeledEditPaint::messageHide_data()
+{
+    addRows({ 50, 150, 250 });
+}
+
+/**
+ * 错误信息逐渐缩小消失
+ */
+void TestLabeledEditPaint::messageHide()
+{
+    QFETCH(int, elapsed);
+    createEdit();
+    advance(1000);
+    edit->showWrong("用户名已存在");
+    advance(2000);
+    edit->setMsgText("");
+    advance(elapsed);
+    benchmarkRender();
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认不需要显示器
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    TestLabeledEditPaint test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_labelededit_paint.moc"
@@ -0,0 +1,250 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QThread>
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include "labelededit.h"
+#include "interactivebuttonbase.h"
+
+/**
+ * 压力测试：大量 LabeledEdit + InteractiveButtonBase 同时工作
+ * 按脚本依次切换焦点、输入文字、批量显示错误/正确/加载、鼠标划过按钮
+ * 输出 JSON 报告：每帧耗时分位数、绘制次数、定时器唤醒次数、内存、构造时间
+ *
+ * 用法：labelededit_stress --edits 1000 --buttons 2000 --frames 120 --output report.json
+ */
+
+/**
+ * 统计全部控件收到的绘制事件与定时器事件
+ */
+class EventCounter : public QObject
+{
+public:
+    qint64 paints = 0;
+    qint64 timers = 0;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint)
+            paints++;
+        else if (event->type() == QEvent::Timer)
+            timers++;
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+/**
+ * 当前进程占用的物理内存（KB），不支持的平台返回 -1
+ */
+static qint64 residentSetKb()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    for (QByteArray line : file.readAll().split('\n'))
+    {
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+}
+
+/**
+ * 帧耗时统计（毫秒）
+ */
+static QJsonObject frameStats(QVector<double> times)
+{
+    QJsonObject obj;
+    if (times.isEmpty())
+        return obj;
+    std::sort(times.begin(), times.end());
+    auto percentile = [&](double p) {
+        int index = qMin(times.size() - 1, static_cast<int>(p * times.size()));
+        return times.at(index);
+    };
+    double sum = 0;
+    for (double t : times)
+        sum += t;
+    obj["frames"] = times.size();
+    obj["mean"] = sum / times.size();
+    obj["p50"] = percentile(0.50);
+    obj["p95"] = percentile(0.95);
+    obj["p99"] = percentile(0.99);
+    obj["max"] = times.last();
+    return obj;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("LabeledEdit / InteractiveButtonBase stress test");
+    parser.addHelpOption();
+    QCommandLineOption edits_option("edits", "Number of LabeledEdit.", "N", "200");
+    QCommandLineOption buttons_option("buttons", "Number of InteractiveButtonBase.", "M", "400");
+    QCommandLineOption frames_option("frames", "Frames of each script phase.", "F", "120");
+    QCommandLineOption output_option("output", "Write the JSON report to this file instead of stdout.", "file");
+    parser.addOptions({ edits_option, buttons_option, frames_option, output_option });
+    parser.process(app);
+
+    const int edit_count = qMax(0, parser.value(edits_option).toInt());
+    const int button_count = qMax(0, parser.value(buttons_option).toInt());
+    const int phase_frames = qMax(1, parser.value(frames_option).toInt());
+    const int frame_interval = FrameScheduler::instance()->interval();
+
+    EventCounter counter;
+    app.installEventFilter(&counter);
+
+    // ==== 构造 ====
+    QElapsedTimer construct_timer;
+    construct_timer.start();
+    QWidget window;
+    QGridLayout* layout = new QGridLayout(&window);
+    layout->setSpacing(0);
+    const int columns = qMax(1, static_cast<int>(std::sqrt(static_cast<double>(edit_count + button_count))));
+    QList<LabeledEdit*> edits;
+    QList<InteractiveButtonBase*> buttons;
+    for (int i = 0; i < edit_count; i++)
+    {
+        LabeledEdit* edit = new LabeledEdit(QString("字段%1").arg(i), &window);
+        edit->setTipText("允许大小写字母、数字、下划线");
+        layout->addWidget(edit, i / columns, i % columns);
+        edits.append(edit);
+    }
+    for (int i = 0; i < button_count; i++)
+    {
+        InteractiveButtonBase* button = new InteractiveButtonBase(QString("按钮%1").arg(i), &window);
+        button->setRadius(4);
+        int index = edit_count + i;
+        layout->addWidget(button, index / columns, index % columns);
+        buttons.append(button);
+    }
+    window.show();
+    QApplication::setActiveWindow(&window);
+    QCoreApplication::processEvents();
+    const qint64 construct_ms = construct_timer.elapsed();
+
+    // ==== 脚本 ====
+    struct Phase
+    {
+        QString name;
+        std::function<void(int)> step; // 参数：本阶段的第几帧
+    };
+    QList<Phase> phases;
+    phases << Phase{ "idle", [](int) {} };
+    phases << Phase{ "focus_cycle", [&](int f) {
+        if (!edits.isEmpty())
+            edits.at(f % edits.size())->editor()->setFocus();
+    } };
+    phases << Phase{ "typing", [&](int f) {
+        if (edits.isEmpty())
+            return ;
+        LabeledEdit* edit = edits.at((f / 10) % edits.size());
+        if (f % 10 == 0)
+            edit->editor()->setFocus();
+        QTest::keyClick(edit->editor(), static_cast<char>('a' + f % 26));
+    } };
+    phases << Phase{ "state_burst", [&](int f) {
+        // 每帧对一批输入框切换状态
+        const int batch = qMax(1, edits.size() / 10);
+        for (int i = 0; i < batch && !edits.isEmpty(); i++)
+        {
+            LabeledEdit* edit = edits.at((f * batch + i) % edits.size());
+            switch ((f + i) % 3)
+            {
+            case 0: edit->showWrong("格式错误", true); break;
+            case 1: edit->showCorrect(); break;
+            default: edit->showLoading(); break;
+            }
+        }
+    } };
+    phases << Phase{ "hover_sweep", [&](int f) {
+        // 鼠标从左到右依次划过按钮
+        if (buttons.isEmpty())
+            return ;
+        const int per_frame = qMax(1, buttons.size() / phase_frames);
+        for (int i = 0; i < per_frame; i++)
+        {
+            int index = (f * per_frame + i) % buttons.size();
+            InteractiveButtonBase* button = buttons.at(index);
+            QEvent enter(QEvent::Enter);
+            QCoreApplication::sendEvent(button, &enter);
+            QMouseEvent move(QEvent::MouseMove, QPointF(button->width() / 3, button->height() / 2), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+            QCoreApplication::sendEvent(button, &move);
+            InteractiveButtonBase* last = buttons.at((index + buttons.size() - per_frame) % buttons.size());
+            QEvent leave(QEvent::Leave);
+            QCoreApplication::sendEvent(last, &leave);
+        }
+    } };
+    phases << Phase{ "settle", [](int) {} };
+
+    // ==== 运行 ====
+    QJsonObject phase_reports;
+    QVector<double> all_times;
+    for (const Phase& phase : phases)
+    {
+        QVector<double> times;
+        const qint64 paints_before = counter.paints, timers_before = counter.timers;
+        QElapsedTimer frame_timer;
+        for (int f = 0; f < phase_frames; f++)
+        {
+            frame_timer.start();
+            phase.step(f);
+            QCoreApplication::processEvents();
+            qint64 ns = frame_timer.nsecsElapsed();
+            times.append(ns / 1e6);
+
+            // 按帧间隔运行，给定时器到期的时间
+            qint64 rest = frame_interval - ns / 1000000;
+            if (rest > 0)
+                QThread::msleep(static_cast<unsigned long>(rest));
+        }
+        QJsonObject report = frameStats(times);
+        report["paint_events"] = counter.paints - paints_before;
+        report["timer_events"] = counter.timers - timers_before;
+        phase_reports[phase.name] = report;
+        all_times += times;
+    }
+
+    QJsonObject root;
+    root["edits"] = edit_count;
+    root["buttons"] = button_count;
+    root["frame_interval_ms"] = frame_interval;
+    root["construction_ms"] = construct_ms;
+    root["frame_time_ms"] = frameStats(all_times);
+    root["paint_events"] = counter.paints;
+    root["timer_events"] = counter.timers;
+    root["scheduler_frames"] = static_cast<double>(FrameScheduler::instance()->frameCount());
+    root["rss_kb"] = residentSetKb();
+    root["phases"] = phase_reports;
+#ifdef WIDGET_PERF_COUNTERS
+    root["widgets"] = PerfRegistry::instance()->snapshot(); // 每个控件的计数
+#endif
+
+    QByteArray json = QJsonDocument(root).toJson();
+    if (parser.isSet(output_option))
+    {
+        QFile file(parser.value(output_option));
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qWarning() << "can't write" << file.fileName();
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+    {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
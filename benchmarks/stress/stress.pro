@@ -0,0 +1,6 @@
+TARGET = labelededit_stress
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    main.cpp
@@ -15,14 +15,15 @@ InteractiveButtonBase::InteractiveButtonBase(QWidget *parent)
       hovering(false), pressing(false),
       hover_timestamp(0), leave_timestamp(0), press_timestamp(0), release_timestamp(0),
       hover_bg_duration(300), press_bg_duration(300), click_ani_duration(300),
-      move_speed(5),
+      move_speed(5), anchor_interval(10), anchor_timestamp(0), anchor_carry(0), hover_carry(0), press_carry(0),
+      ani_suspended(false), ani_resume(false), suspend_timestamp(0),
       icon_color(0, 0, 0), text_color(0,0,0),
       normal_bg(0xF2, 0xF2, 0xF2, 0), hover_bg(128, 128, 128, 32), press_bg(128, 128, 128, 64), border_bg(0,0,0,0),
       focus_bg(0,0,0,0), focus_border(0,0,0,0),
       hover_speed(5), press_start(40), press_speed(5),
       hover_progress(0), press_progress(0), icon_padding_proper(0.25), icon_text_padding(4), icon_text_size(16),
-      border_width(1), radius_x(0), radius_y(0),
-      font_size(0), fixed_fore_pos(false), fixed_fore_size(false), text_dynamic_size(false), auto_text_color(true), focusing(false),
+      border_width(1), radius_x(0), radius_y(0), bg_path_dirty(true), layer_cache(true),
+      addin_layer_key(0), font_size(0), font_scale_ani(false), font_scale_size(0), font_scale_color(0), font_scale_image_size(0), font_size_ani(nullptr), fixed_fore_pos(false), fixed_fore_size(false), text_dynamic_size(false), auto_text_color(true), focusing(false),
       click_ani_appearing(false), click_ani_disappearing(false), click_ani_progress(0),
       mouse_press_event(nullptr), mouse_release_event(nullptr),
       unified_geometry(false), _l(0), _t(0), _w(32), _h(32),
@@ -35,10 +36,6 @@ InteractiveButtonBase::InteractiveButtonBase(QWidget *parent)
 
     model = PaintModel::None;
 
-    anchor_timer = new QTimer(this);
-    anchor_timer->setInterval(10);
-    connect(anchor_timer, SIGNAL(timeout()), this, SLOT(anchorTimeOut()));
-
     setWaterRipple();
 
     connect(this, SIGNAL(clicked()), this, SLOT(slotClicked()));
@@ -177,12 +174,12 @@ void InteractiveButtonBase::setIcon(QIcon icon)
     }
     else if (model == PaintModel::PixmapMask)
     {
-        pixmap = QPixmap();
+        pixmap = pixmap_origin = QPixmap();
         model = PaintModel::Icon;
     }
     else if (model == PaintModel::PixmapText)
     {
-        pixmap = QPixmap();
+        pixmap = pixmap_origin = QPixmap();
         if (text.isEmpty())
             model = PaintModel::Icon;
         else
@@ -231,6 +228,7 @@ void InteractiveButtonBase::setPixmap(QPixmap pixmap)
         QFontMetrics fm(this->font());
         icon_text_size = fm.lineSpacing();
     }
+    this->pixmap_origin = pixmap;
     this->pixmap = getMaskPixmap(pixmap, isEnabled()?icon_color:getOpacityColor(icon_color));
     if (parent_enabled)
         QPushButton::setIcon(QIcon(pixmap));
@@ -245,10 +243,8 @@ void InteractiveButtonBase::setPixmap(QPixmap pixmap)
  */
 void InteractiveButtonBase::setPaintAddin(QPixmap pixmap, Qt::Alignment align, QSize size)
 {
-    QBitmap mask = pixmap.mask();
-    pixmap.fill(icon_color);
-    pixmap.setMask(mask);
     paint_addin = PaintAddin(pixmap, align, size);
+    paint_addin.pixmap = getMaskPixmap(pixmap, icon_color);
     update();
 }
 
@@ -459,13 +455,13 @@ void InteractiveButtonBase::setIconColor(QColor color)
     // 绘制图标（如果有）
     if (model == PaintModel::PixmapMask || model == PaintModel::PixmapText)
     {
-        pixmap = getMaskPixmap(pixmap, isEnabled()?icon_color:getOpacityColor(icon_color));
+        pixmap = getMaskPixmap(pixmap_origin, isEnabled()?icon_color:getOpacityColor(icon_color));
     }
 
     // 绘制额外角标（如果有的话）
     if (paint_addin.enable)
     {
-        paint_addin.pixmap = getMaskPixmap(paint_addin.pixmap, isEnabled()?icon_color:getOpacityColor(icon_color));
+        paint_addin.pixmap = getMaskPixmap(paint_addin.origin, isEnabled()?icon_color:getOpacityColor(icon_color));
     }
 
     update();
@@ -517,13 +513,38 @@ void InteractiveButtonBase::setFontSize(int f)
     }
     else // 改变字体大小，使用字体缩放动画
     {
+        if (font_size_ani) // 上一个动画还没结束，从当前字号接着变化；stop 不会发出 finished
+        {
+            font_size_ani->stop();
+            font_size_ani->deleteLater();
+            font_size_ani = nullptr;
+            if (font_scale_size) // 缩放动画中字体还没改过，先落到当前字号，和 font_size 保持一致
+            {
+                QFont font(this->font());
+                font.setPointSize(font_size);
+                setFont(font);
+            }
+        }
+        // 只用两端中较大的字号绘制文字，动画中缩放
+        font_scale_size = font_scale_ani ? qMax(font_size, f) : 0;
         QPropertyAnimation* ani = new QPropertyAnimation(this, "font_size");
+        font_size_ani = ani;
         ani->setStartValue(font_size);
         ani->setEndValue(f);
         ani->setDuration(click_ani_duration);
         connect(ani, &QPropertyAnimation::finished, [=]{
+            if (font_scale_size) // 结束时才真正修改字体
+            {
+                font_scale_size = 0;
+                font_scale_image = QImage();
+                QFont font(this->font());
+                font.setPointSize(f);
+                setFont(font);
+                update();
+            }
             QFontMetrics fm(this->font());
             icon_text_size = fm.lineSpacing();
+            font_size_ani = nullptr;
             ani->deleteLater();
         });
         ani->start();
@@ -561,12 +582,25 @@ int InteractiveButtonBase::getFontSizeT()
 void InteractiveButtonBase::setFontSizeT(int f)
 {
     this->font_size = f;
-    QFont font(this->font());
-    font.setPointSize(f);
-    setFont(font);
+    if (!font_scale_size) // 缩放动画中不修改字体
+    {
+        QFont font(this->font());
+        font.setPointSize(f);
+        setFont(font);
+    }
     update();
 }
 
+/**
+ * 字体大小动画（setFontSize）使用缩放
+ * 逐帧 setFont 时每个字号都会创建新的字体引擎与字形缓存，并且发送字体改变事件；
+ * 开启后只在较大的一端绘制一次文字，动画中缩小图片，结束时设置一次字体
+ */
+void InteractiveButtonBase::setFontScaleAni(bool enable)
+{
+    font_scale_ani = enable;
+}
+
 /**
  * 如果点击失去焦点的话，即使鼠标移到上面，也不会出现背景
  * 可以用这个方法继续保持悬浮状态
@@ -594,6 +628,7 @@ void InteractiveButtonBase::setAlign(Qt::Alignment a)
 void InteractiveButtonBase::setRadius(int r)
 {
     radius_x = radius_y = r;
+    invalidateBgPath();
 }
 
 /**
@@ -605,6 +640,7 @@ void InteractiveButtonBase::setRadius(int rx, int ry)
 {
     radius_x = rx;
     radius_y = ry;
+    invalidateBgPath();
 }
 
 /**
@@ -635,7 +671,7 @@ void InteractiveButtonBase::setDisabled(bool dis)
 
     if (model == PixmapMask || model == PixmapText)
     {
-        pixmap = getMaskPixmap(pixmap, dis?getOpacityColor(icon_color):icon_color);
+        pixmap = getMaskPixmap(pixmap_origin, dis?getOpacityColor(icon_color):icon_color);
     }
 
     update(); // 修改透明度
@@ -860,8 +896,7 @@ void InteractiveButtonBase::showForeground()
 {
     if (!show_animation) return ;
     waters.clear();
-    if (!anchor_timer->isActive())
-        anchor_timer->start();
+    subscribeFrames();
     if (show_ani_disappearing)
         show_ani_disappearing = false;
     show_ani_appearing = true;
@@ -893,8 +928,7 @@ void InteractiveButtonBase::showForeground2(QPoint point)
 void InteractiveButtonBase::hideForeground()
 {
     if (!show_animation) return ;
-    if (!anchor_timer->isActive())
-        anchor_timer->start();
+    subscribeFrames();
     if (show_ani_appearing)
         show_ani_appearing = false;
     show_ani_disappearing = true;
@@ -1035,10 +1069,7 @@ void InteractiveButtonBase::enterEvent(QEvent *event)
         return ;
     }
 
-    if (!anchor_timer->isActive())
-    {
-        anchor_timer->start();
-    }
+    subscribeFrames();
     hovering = true;
     hover_timestamp = getTimestamp();
     leave_timestamp = 0;
@@ -1214,6 +1245,7 @@ void InteractiveButtonBase::resizeEvent(QResizeEvent *event)
         anchor_pos = mouse_pos;
     }
     water_radius = static_cast<int>(max(geometry().width(), geometry().height()) * 1.42); // 长边
+    invalidateBgPath();
     // 非固定的情况，尺寸大小变了之后所有 padding 都要变
     if (model == PaintModel::Icon || model == PaintModel::PixmapMask)
     {
@@ -1279,31 +1311,20 @@ void InteractiveButtonBase::paintEvent(QPaintEvent* event)
         QPushButton::paintEvent(event);
     if (!self_enabled) // 不绘制自己
         return ;
+    PERF_PAINT_SCOPE(perf_counters);
+    TRACE_SCOPE("InteractiveButtonBase", "paintEvent");
     QPainter painter(this);
 
     // ==== 绘制背景 ====
-    QPainterPath path_back = getBgPainterPath();
+    const QPainterPath& path_back = getCachedBgPath();
     painter.setRenderHint(QPainter::Antialiasing,true);
 
-    if (normal_bg.alpha() != 0) // 默认背景
-    {
-        painter.fillPath(path_back, isEnabled()?normal_bg:getOpacityColor(normal_bg));
-    }
-    if (focusing && focus_bg.alpha() != 0) // 焦点背景
-    {
-        painter.fillPath(path_back, focus_bg);
-    }
-
-    if ((border_bg.alpha() != 0 || (focusing && focus_border.alpha() != 0)) && border_width > 0)
-    {
-        painter.save();
-        QPen pen;
-        pen.setColor((focusing && focus_border.alpha()) ? focus_border : border_bg);
-        pen.setWidth(border_width);
-        painter.setPen(pen);
-        painter.drawPath(path_back);
-        painter.restore();
-    }
+    // 动画中每一帧通常只有悬浮、按下的透明度在变，不变的部分使用缓存的图层
+    const bool use_layers = layer_cache && FrameScheduler::instance()->isSubscribed(this);
+    if (use_layers)
+        painter.drawImage(QPoint(0, 0), getBgLayer());
+    else
+        paintBackground(painter);
 
     if (hover_progress) // 悬浮背景
     {
@@ -1327,29 +1348,11 @@ void InteractiveButtonBase::paintEvent(QPaintEvent* event)
         // 绘制额外内容（可能被前景覆盖）
         if (paint_addin.enable)
         {
-            int l = fore_paddings.left, t = fore_paddings.top, r = size().width()-fore_paddings.right, b = size().height()-fore_paddings.bottom;
-            int small_edge = min(size().height(), size().width());
-            int pw = paint_addin.size.width() ? paint_addin.size.width() : small_edge-fore_paddings.left-fore_paddings.right;
-            int ph = paint_addin.size.height() ? paint_addin.size.height() : small_edge-fore_paddings.top-fore_paddings.bottom;
-            if (paint_addin.align & Qt::AlignLeft)
-                r = l + pw;
-            else if (paint_addin.align & Qt::AlignRight)
-                l = r - pw;
-            else if (paint_addin.align & Qt::AlignHCenter)
-            {
-                l = size().width()/2-pw/2;
-                r = l+pw;
-            }
-            if (paint_addin.align & Qt::AlignTop)
-                b = t + ph;
-            else if (paint_addin.align & Qt::AlignBottom)
-                t = b - ph;
-            else if (paint_addin.align & Qt::AlignVCenter)
-            {
-                t = size().height()/2-ph/2;
-                b = t+ph;
-            }
-            painter.drawPixmap(QRect(l,t,r-l,b-t), paint_addin.pixmap);
+            const QRect addin_rect = getAddinRect();
+            if (use_layers) // 不随前景移动，缓存缩放好的图片
+                painter.drawImage(addin_rect.topLeft(), getAddinLayer(addin_rect.size()));
+            else
+                painter.drawPixmap(addin_rect, paint_addin.pixmap);
         }
 
         QRect& rect = paint_rect;
@@ -1420,61 +1423,28 @@ void InteractiveButtonBase::paintEvent(QPaintEvent* event)
             painter.setPen(color);
         }*/
 
-        if (model == None)
-        {
-            // 子类自己的绘制内容
-        }
-        else if (model == Text)
-        {
-            // 绘制文字教程： https://blog.csdn.net/temetnosce/article/details/78068464
-            painter.setPen(isEnabled()?text_color:getOpacityColor(text_color));
-            /*if (show_ani_appearing || show_ani_disappearing)
-            {
-                int pro = getSpringBackProgress(show_ani_progress, 50);
-                QFont font = painter.font();
-                int ps = font.pointSize();
-                ps = ps * show_ani_progress / 100;
-                font.setPointSize(ps);
-                painter.setFont(font);
-            }*/
-            if (font_size > 0)
-            {
-                QFont font = painter.font();
-                font.setPointSize(font_size);
-                painter.setFont(font);
-            }
-            painter.drawText(rect, static_cast<int>(align), text);
-        }
-        else if (model == Icon) // 绘制图标
-        {
-            icon.paint(&painter, rect, align, getIconMode());
-        }
-        else if (model == PixmapMask)
-        {
-            painter.setRenderHint(QPainter::SmoothPixmapTransform, true); // 可以让边缘看起来平滑一些
-            painter.drawPixmap(rect, pixmap);
-        }
-        else if (model == IconText || model == PixmapText) // 强制左对齐；左图标中文字
+        // 没有缩放时，前景只是静止位置的平移，直接贴上缓存的图层
+        // 文字画到透明图层上只有灰度抗锯齿，和直接绘制的粗细不同，所以只缓存图标
+        const QRect rest_rect = getForeRestRect();
+        const bool use_fore_layer = use_layers && (model == Icon || model == PixmapMask) && rect.size() == rest_rect.size();
+        const QPoint fore_offset = rect.topLeft() - rest_rect.topLeft();
+
+        if (model == IconText || model == PixmapText) // 强制左对齐；左图标中文字
         {
-            // 绘制图标
+            // 绘制图标（与文字的偏移不同，不放入图层）
             int& sz = icon_text_size;
             QRect icon_rect(rect.left(), rect.top() + rect.height()/2 - sz / 2, sz, sz);
             icon_rect.moveTo(icon_rect.left() - quick_sqrt(offset_pos.x()), icon_rect.top() - quick_sqrt(offset_pos.y()));
             drawIconBeforeText(painter, icon_rect);
             rect.setLeft(rect.left() + sz + icon_text_padding);
-
-            // 绘制文字
             // 扩展文字范围，确保文字可见
-            painter.setPen(isEnabled()?text_color:getOpacityColor(text_color));
             rect.setWidth(rect.width() + sz + icon_text_padding);
-            if (font_size > 0)
-            {
-                QFont font = painter.font();
-                font.setPointSize(font_size);
-                painter.setFont(font);
-            }
-            painter.drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, text);
         }
+
+        if (use_fore_layer)
+            painter.drawImage(fore_offset, getForeLayer());
+        else
+            paintForeground(painter, rect);
     }
 
     // ==== 绘制鼠标位置 ====
@@ -1484,6 +1454,285 @@ void InteractiveButtonBase::paintEvent(QPaintEvent* event)
     //    return QPushButton::paintEvent(event); // 不绘制父类背景了
 }
 
+/**
+ * 绘制不随动画变化的背景：默认背景、焦点背景、边框
+ */
+void InteractiveButtonBase::paintBackground(QPainter &painter)
+{
+    const QPainterPath& path_back = getCachedBgPath();
+    if (normal_bg.alpha() != 0) // 默认背景
+    {
+        painter.fillPath(path_back, isEnabled()?normal_bg:getOpacityColor(normal_bg));
+    }
+    if (focusing && focus_bg.alpha() != 0) // 焦点背景
+    {
+        painter.fillPath(path_back, focus_bg);
+    }
+
+    if ((border_bg.alpha() != 0 || (focusing && focus_border.alpha() != 0)) && border_width > 0)
+    {
+        painter.save();
+        QPen pen;
+        pen.setColor((focusing && focus_border.alpha()) ? focus_border : border_bg);
+        pen.setWidth(border_width);
+        painter.setPen(pen);
+        painter.drawPath(path_back);
+        painter.restore();
+    }
+}
+
+/**
+ * 在 rect 中绘制前景的文字或图标
+ * IconText/PixmapText 模式下只绘制文字，rect 已经是文字的区域
+ */
+void InteractiveButtonBase::paintForeground(QPainter &painter, const QRect &rect)
+{
+    if (model == None)
+    {
+        // 子类自己的绘制内容
+    }
+    else if (model == Text)
+    {
+        // 绘制文字教程： https://blog.csdn.net/temetnosce/article/details/78068464
+        painter.setPen(isEnabled()?text_color:getOpacityColor(text_color));
+        if (font_scale_size && font_size != font_scale_size)
+        {
+            drawScaledText(painter, rect, align);
+            return ;
+        }
+        if (font_size > 0)
+        {
+            QFont font = painter.font();
+            font.setPointSize(font_size);
+            painter.setFont(font);
+        }
+        painter.drawText(rect, static_cast<int>(align), text);
+    }
+    else if (model == Icon) // 绘制图标
+    {
+        icon.paint(&painter, rect, align, getIconMode());
+    }
+    else if (model == PixmapMask)
+    {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, true); // 可以让边缘看起来平滑一些
+        painter.drawPixmap(rect, pixmap);
+    }
+    else if (model == IconText || model == PixmapText)
+    {
+        painter.setPen(isEnabled()?text_color:getOpacityColor(text_color));
+        if (font_scale_size && font_size != font_scale_size)
+        {
+            drawScaledText(painter, rect, Qt::AlignLeft | Qt::AlignVCenter);
+            return ;
+        }
+        if (font_size > 0)
+        {
+            QFont font = painter.font();
+            font.setPointSize(font_size);
+            painter.setFont(font);
+        }
+        painter.drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, text);
+    }
+}
+
+/**
+ * 字体缩放动画中绘制文字
+ * 文字只按 font_scale_size 绘制一次，再按当前字号缩小，对齐方式与 drawText 一致
+ */
+void InteractiveButtonBase::drawScaledText(QPainter &painter, const QRect &rect, Qt::Alignment a)
+{
+    const QColor color = painter.pen().color();
+    QFont font(this->font());
+    font.setPointSize(font_scale_size);
+    QFontMetricsF fm(font);
+    const int margin = 1; // 字形可能超出步进宽度
+    if (font_scale_image.isNull() || font_scale_text != text || font_scale_color != color.rgba()
+            || font_scale_image_size != font_scale_size || font_scale_font != font
+            || !qFuzzyCompare(font_scale_image.devicePixelRatio(), devicePixelRatioF()))
+    {
+        const qreal dpr = devicePixelRatioF();
+        QImage image((QSizeF(fm.horizontalAdvance(text) + margin * 2, fm.height()) * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+        image.fill(Qt::transparent);
+        QPainter text_painter(&image);
+        text_painter.setFont(font);
+        text_painter.setPen(color);
+        text_painter.drawText(QPointF(margin, fm.ascent()), text);
+        text_painter.end();
+        font_scale_image = image;
+        font_scale_text = text;
+        font_scale_color = color.rgba();
+        font_scale_image_size = font_scale_size;
+        font_scale_font = font;
+    }
+
+    const double scale = static_cast<double>(font_size) / font_scale_size;
+    const double w = (fm.horizontalAdvance(text) + margin * 2) * scale, h = fm.height() * scale;
+    double x = rect.left() + (rect.width() - w) / 2, y = rect.top() + (rect.height() - h) / 2;
+    if (a & Qt::AlignLeft)
+        x = rect.left() - margin * scale;
+    else if (a & Qt::AlignRight)
+        x = rect.left() + rect.width() - w + margin * scale;
+    if (a & Qt::AlignTop)
+        y = rect.top();
+    else if (a & Qt::AlignBottom)
+        y = rect.top() + rect.height() - h;
+
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    QTransform transform;
+    transform.translate(x, y);
+    transform.scale(scale, scale);
+    painter.setTransform(transform, true);
+    painter.drawImage(QPointF(0, 0), font_scale_image);
+    painter.restore();
+}
+
+/**
+ * 前景静止时（没有偏移、缩放）的绘制区域
+ */
+QRect InteractiveButtonBase::getForeRestRect()
+{
+    return QRect(fore_paddings.left, fore_paddings.top,
+                 size().width()-fore_paddings.left-fore_paddings.right,
+                 size().height()-fore_paddings.top-fore_paddings.bottom);
+}
+
+/**
+ * 创建和按钮一样大的透明图层
+ */
+QImage InteractiveButtonBase::createLayer()
+{
+    const qreal dpr = devicePixelRatioF();
+    QImage layer(size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    layer.setDevicePixelRatio(dpr);
+    layer.fill(Qt::transparent);
+    return layer;
+}
+
+/**
+ * 背景图层，颜色、焦点、尺寸改变时重新绘制
+ */
+const QImage &InteractiveButtonBase::getBgLayer()
+{
+    BgLayerKey key;
+    key.size = size();
+    key.dpr = devicePixelRatioF();
+    key.enabled = isEnabled();
+    key.focusing = focusing;
+    key.normal = normal_bg.rgba();
+    key.focus = focus_bg.rgba();
+    key.focus_border = focus_border.rgba();
+    key.border = border_bg.rgba();
+    key.border_width = border_width;
+    if (bg_layer.isNull() || !(key == bg_layer_key))
+    {
+        bg_layer = createLayer();
+        bg_layer_key = key;
+        QPainter painter(&bg_layer);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        paintBackground(painter);
+    }
+    return bg_layer;
+}
+
+/**
+ * 前景（Icon、PixmapMask）静止位置的图层，图标、尺寸改变时重新绘制
+ */
+const QImage &InteractiveButtonBase::getForeLayer()
+{
+    ForeLayerKey key;
+    key.model = model;
+    key.size = size();
+    key.dpr = devicePixelRatioF();
+    key.rect = getForeRestRect();
+    key.align = align;
+    key.icon_key = icon.cacheKey();
+    key.icon_mode = getIconMode();
+    key.pixmap_key = pixmap.cacheKey();
+    if (fore_layer.isNull() || !(key == fore_layer_key))
+    {
+        fore_layer = createLayer();
+        fore_layer_key = key;
+        QPainter painter(&fore_layer);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        paintForeground(painter, key.rect);
+    }
+    return fore_layer;
+}
+
+/**
+ * 额外内容（setPaintAddin）的绘制区域
+ */
+QRect InteractiveButtonBase::getAddinRect()
+{
+    int l = fore_paddings.left, t = fore_paddings.top, r = size().width()-fore_paddings.right, b = size().height()-fore_paddings.bottom;
+    int small_edge = min(size().height(), size().width());
+    int pw = paint_addin.size.width() ? paint_addin.size.width() : small_edge-fore_paddings.left-fore_paddings.right;
+    int ph = paint_addin.size.height() ? paint_addin.size.height() : small_edge-fore_paddings.top-fore_paddings.bottom;
+    if (paint_addin.align & Qt::AlignLeft)
+        r = l + pw;
+    else if (paint_addin.align & Qt::AlignRight)
+        l = r - pw;
+    else if (paint_addin.align & Qt::AlignHCenter)
+    {
+        l = size().width()/2-pw/2;
+        r = l+pw;
+    }
+    if (paint_addin.align & Qt::AlignTop)
+        b = t + ph;
+    else if (paint_addin.align & Qt::AlignBottom)
+        t = b - ph;
+    else if (paint_addin.align & Qt::AlignVCenter)
+    {
+        t = size().height()/2-ph/2;
+        b = t+ph;
+    }
+    return QRect(l,t,r-l,b-t);
+}
+
+/**
+ * 缩放到绘制区域大小的额外内容，图片、尺寸改变时重新绘制
+ * 绘制在悬浮、按下、水波纹之上，不能和背景放在同一个图层
+ */
+const QImage &InteractiveButtonBase::getAddinLayer(const QSize &size)
+{
+    const qreal dpr = devicePixelRatioF();
+    const qint64 key = paint_addin.pixmap.cacheKey();
+    if (addin_layer.isNull() || addin_layer_key != key || addin_layer_size != size || addin_layer.devicePixelRatio() != dpr)
+    {
+        addin_layer = QImage(size * dpr, QImage::Format_ARGB32_Premultiplied);
+        addin_layer.setDevicePixelRatio(dpr);
+        addin_layer.fill(Qt::transparent);
+        addin_layer_key = key;
+        addin_layer_size = size;
+        QPainter painter(&addin_layer);
+        painter.drawPixmap(QRect(QPoint(0, 0), size), paint_addin.pixmap);
+    }
+    return addin_layer;
+}
+
+/**
+ * 是否在动画中使用分层缓存，默认开启
+ * 子类在 drawIconBeforeText、paintEvent 等地方依赖额外状态时，可以关闭或者调用 invalidateLayers()
+ */
+void InteractiveButtonBase::setLayerCache(bool enable)
+{
+    layer_cache = enable;
+    if (!enable)
+        invalidateLayers();
+}
+
+/**
+ * 释放缓存的图层，下一次动画时重新绘制
+ */
+void InteractiveButtonBase::invalidateLayers()
+{
+    bg_layer = QImage();
+    fore_layer = QImage();
+    addin_layer = QImage();
+}
+
 /**
  * IconText/PixmapText模式下，绘制图标
  * 可扩展到绘制图标背景色（模仿menu选中、禁用情况）等
@@ -1524,8 +1773,28 @@ QPainterPath InteractiveButtonBase::getBgPainterPath()
 }
 
 /**
- * 获取水波纹绘制区域（圆形，但不规则区域）
- * 圆形水面 & 按钮区域
+ * 缓存的背景区域，避免每次绘制都重新生成
+ * 子类异形按钮的形状改变时（除了尺寸、圆角），需要调用 invalidateBgPath()
+ */
+const QPainterPath &InteractiveButtonBase::getCachedBgPath()
+{
+    if (bg_path_dirty)
+    {
+        bg_path = getBgPainterPath();
+        bg_path_dirty = false;
+    }
+    return bg_path;
+}
+
+void InteractiveButtonBase::invalidateBgPath()
+{
+    bg_path_dirty = true;
+    bg_layer = QImage();
+}
+
+/**
+ * 获取水波纹绘制区域（圆形）
+ * 超出按钮的部分在绘制时裁剪掉（见 paintWaterRipple）
  * @param  water 一面水波纹动画对象
  * @return       绘制路径
  */
@@ -1543,8 +1812,6 @@ QPainterPath InteractiveButtonBase::getWaterPainterPath(InteractiveButtonBase::W
                 water_radius*water.progress/50);*/
     QPainterPath path;
     path.addEllipse(circle);
-    if (radius_x || radius_y)
-        return path & getBgPainterPath();
     return path;
 }
 
@@ -1606,23 +1873,46 @@ void InteractiveButtonBase::updateUnifiedGeometry()
 void InteractiveButtonBase::paintWaterRipple(QPainter& painter)
 {
     QColor water_finished_color(press_bg);
+    const QPainterPath& path_back = getCachedBgPath();
+    const bool rounded = radius_x || radius_y;
+    const QRect inner = rect().adjusted(radius_x, radius_y, -radius_x, -radius_y); // 不受圆角影响的区域
+    bool clipped = false;
 
     for (int i = 0; i < waters.size(); i++)
     {
-        Water water = waters.at(i);
+        const Water& water = waters.at(i);
         if (water.finished) // 渐变消失
         {
             water_finished_color.setAlpha(press_bg.alpha() * water.progress / 100);
-            QPainterPath path_back = getBgPainterPath();
 //                painter.setPen(water_finished_color);
             painter.fillPath(path_back, QBrush(water_finished_color));
         }
         else // 圆形出现
         {
             QPainterPath path = getWaterPainterPath(water);
-            painter.fillPath(path, QBrush(press_bg));
+            if (!rounded || inner.contains(path.boundingRect().toAlignedRect())) // 完全在圆角里面，不需要裁剪
+            {
+                painter.fillPath(path, QBrush(press_bg));
+            }
+            else if (path.contains(QPointF(0, 0)) && path.contains(QPointF(width(), 0))
+                     && path.contains(QPointF(0, height())) && path.contains(QPointF(width(), height()))) // 已经覆盖整个按钮
+            {
+                painter.fillPath(path_back, QBrush(press_bg));
+            }
+            else // 与圆角相交：裁剪到背景区域，所有水波纹共用同一个裁剪
+            {
+                if (!clipped)
+                {
+                    painter.save();
+                    painter.setClipPath(path_back, Qt::IntersectClip);
+                    clipped = true;
+                }
+                painter.fillPath(path, QBrush(press_bg));
+            }
         }
     }
+    if (clipped)
+        painter.restore();
 }
 
 /**
@@ -1718,12 +2008,14 @@ int InteractiveButtonBase::max(int a, int b) const { return a > b ? a : b; }
 int InteractiveButtonBase::min(int a, int b) const { return a < b ? a : b; }
 
 /**
- * 获取现行时间戳，13位，精确到毫秒
+ * 获取现行时间戳，精确到毫秒
+ * 使用全局的动画时钟（单调时钟，或测试用的虚拟时间）
+ * 暂停中停在暂停的那一刻，恢复后所有时间戳整体往后平移
  * @return 时间戳
  */
 qint64 InteractiveButtonBase::getTimestamp() const
 {
-    return QDateTime::currentDateTime().toMSecsSinceEpoch();
+    return ani_suspended ? suspend_timestamp : AnimationClock::now();
 }
 
 /**
@@ -1766,16 +2058,14 @@ QColor InteractiveButtonBase::getOpacityColor(QColor color, double level)
 
 /**
  * 获取对应颜色的图标 pixmap
- * @param  p 图标
+ * 结果在所有按钮之间共用，相同图标、相同颜色只着色一次
+ * @param  p 图标（原图）
  * @param  c 颜色
  * @return   对应颜色的图标
  */
 QPixmap InteractiveButtonBase::getMaskPixmap(QPixmap p, QColor c)
 {
-    QBitmap mask = p.mask();
-    p.fill(c);
-    p.setMask(mask);
-    return p;
+    return TintedPixmapCache::tinted(p, c);
 }
 
 double InteractiveButtonBase::getNolinearProg(int p, InteractiveButtonBase::NolinearType type)
@@ -1814,13 +2104,151 @@ QIcon::Mode InteractiveButtonBase::getIconMode()
     return isEnabled() ? (getState() ? QIcon::Selected : (hovering||pressing ? QIcon::Active : QIcon::Normal)) : QIcon::Disabled;
 }
 
+/**
+ * 全局帧时钟的回调
+ * 动画中才会订阅，结束后在 anchorTimeOut 中取消
+ */
+void InteractiveButtonBase::frameTick()
+{
+    // 窗口最小化、被遮挡时不会收到 hideEvent，等到重新显示出来再继续
+    if (!FrameScheduler::isExposed(this))
+    {
+        suspendAnimations();
+        if (isVisible() && window()->windowHandle())
+            window()->windowHandle()->installEventFilter(this);
+        return ;
+    }
+    anchorTimeOut();
+}
+
+/**
+ * 开始逐帧刷新
+ * 暂停中只做标记，重新可见时再订阅
+ */
+void InteractiveButtonBase::subscribeFrames()
+{
+    if (ani_suspended)
+    {
+        ani_resume = true;
+        return ;
+    }
+    PERF_ANIMATION(perf_counters, FrameScheduler::instance()->isSubscribed(this));
+    FrameScheduler::instance()->subscribe(this);
+}
+
+/**
+ * 看不见时暂停所有动画，不再占用帧时钟
+ */
+void InteractiveButtonBase::suspendAnimations()
+{
+    if (ani_suspended)
+        return ;
+    ani_resume = FrameScheduler::instance()->isSubscribed(this);
+    suspend_timestamp = getTimestamp();
+    ani_suspended = true;
+    FrameScheduler::instance()->unsubscribe(this);
+    invalidateLayers();
+}
+
+/**
+ * 重新可见时从暂停的位置继续
+ * 所有动画相关的时间戳往后平移暂停的时长（0 表示没有发生，保持不变）
+ */
+void InteractiveButtonBase::resumeAnimations()
+{
+    if (!ani_suspended)
+        return ;
+    ani_suspended = false;
+    const qint64 delta = getTimestamp() - suspend_timestamp;
+    auto shift = [=](qint64& t) {
+        if (t)
+            t += delta;
+    };
+    shift(show_timestamp);
+    shift(hide_timestamp);
+    shift(hover_timestamp);
+    shift(leave_timestamp);
+    shift(press_timestamp);
+    shift(release_timestamp);
+    for (int i = 0; i < waters.size(); i++)
+    {
+        shift(waters[i].press_timestamp);
+        shift(waters[i].release_timestamp);
+        shift(waters[i].finish_timestamp);
+    }
+    for (int i = 0; i < jitters.size(); i++)
+        shift(jitters[i].timestamp);
+    anchor_timestamp = 0; // 暂停的时间不算作经过的时间
+    anchor_carry = 0;
+    hover_carry = press_carry = 0;
+
+    if (ani_resume)
+    {
+        ani_resume = false;
+        subscribeFrames();
+    }
+}
+
+void InteractiveButtonBase::showEvent(QShowEvent *event)
+{
+    QPushButton::showEvent(event);
+    resumeAnimations();
+}
+
+void InteractiveButtonBase::hideEvent(QHideEvent *event)
+{
+    QPushButton::hideEvent(event);
+    suspendAnimations();
+}
+
+/**
+ * 监听所在窗口重新显示（从最小化、遮挡中恢复）
+ */
+bool InteractiveButtonBase::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Expose && FrameScheduler::isExposed(this))
+    {
+        watched->removeEventFilter(this);
+        resumeAnimations();
+    }
+    return QPushButton::eventFilter(watched, event);
+}
+
 /**
  * 锚点变成到鼠标位置的定时时钟
  * 同步计算所有和时间或者帧数有关的动画和属性
  */
 void InteractiveButtonBase::anchorTimeOut()
 {
+    TRACE_SCOPE("InteractiveButtonBase", "anchorTimeOut");
     qint64 timestamp = getTimestamp();
+#ifdef WIDGET_PERF_COUNTERS
+    // 这一帧前后的动画状态，什么都没改变的帧记为浪费
+    auto aniState = [this]{
+        int water_prog = 0;
+        for (const Water& water : waters)
+            water_prog += water.progress;
+        return QVector<int>{ hover_progress, press_progress, show_ani_progress, click_ani_progress,
+                    anchor_pos.x(), anchor_pos.y(), effect_pos.x(), effect_pos.y(),
+                    waters.size(), water_prog, jitters.size() };
+    };
+    const QVector<int> ani_state = aniState();
+#endif
+
+    // 按经过的时间推进动画，而不是按帧数，掉帧时会追上进度
+    // 速度参数都是按每 anchor_interval 毫秒一次设定的
+    qint64 elapsed = anchor_timestamp ? timestamp - anchor_timestamp : anchor_interval;
+    anchor_timestamp = timestamp;
+    if (elapsed < 0)
+        elapsed = 0;
+    // 每帧的进度取整后，不足 1 的部分留到下一帧，避免帧率高时累计误差
+    hover_carry += hover_speed * elapsed / static_cast<double>(anchor_interval);
+    press_carry += press_speed * elapsed / static_cast<double>(anchor_interval);
+    const int hover_step = static_cast<int>(hover_carry);
+    const int press_step = static_cast<int>(press_carry);
+    hover_carry -= hover_step;
+    press_carry -= press_step;
+
     // ==== 背景色 ====
     /*if (hovering) // 在框内：加深
     {
@@ -1848,7 +2276,7 @@ void InteractiveButtonBase::anchorTimeOut()
     {
         if (press_progress < 100) // 透明渐变，且没有完成
         {
-            press_progress += press_speed;
+            press_progress += press_step;
             if (press_progress >= 100)
             {
                 press_progress = 100;
@@ -1861,7 +2289,7 @@ void InteractiveButtonBase::anchorTimeOut()
         }
         if (hovering && hover_progress < 100)
         {
-            hover_progress += hover_speed;
+            hover_progress += hover_step;
             if (hover_progress >= 100)
             {
                 hover_progress = 100;
@@ -1873,7 +2301,7 @@ void InteractiveButtonBase::anchorTimeOut()
     {
         if (press_progress>0) // 如果按下的效果还在，变浅
         {
-            press_progress -= press_speed;
+            press_progress -= press_step;
             if (press_progress <= 0)
             {
                 press_progress = 0;
@@ -1889,7 +2317,7 @@ void InteractiveButtonBase::anchorTimeOut()
         {
             if (hover_progress < 100)
             {
-                hover_progress += hover_speed;
+                hover_progress += hover_step;
                 if (hover_progress >= 100)
                 {
                     hover_progress = 100;
@@ -1901,7 +2329,7 @@ void InteractiveButtonBase::anchorTimeOut()
         {
             if (hover_progress > 0)
             {
-                hover_progress -= hover_speed;
+                hover_progress -= hover_step;
                 if (hover_progress <= 0)
                 {
                     hover_progress = 0;
@@ -1971,7 +2399,7 @@ void InteractiveButtonBase::anchorTimeOut()
     {
         if (show_ani_appearing) // 出现
         {
-            qint64 delta = getTimestamp() - show_timestamp;
+            qint64 delta = timestamp - show_timestamp;
             if (show_ani_progress >= 100) // 出现结束
             {
                 show_ani_appearing = false;
@@ -1986,7 +2414,7 @@ void InteractiveButtonBase::anchorTimeOut()
         }
         if (show_ani_disappearing) // 消失
         {
-            qint64 delta = getTimestamp() - hide_timestamp;
+            qint64 delta = timestamp - hide_timestamp;
             if (show_ani_progress <= 0) // 消失结束
             {
                 show_ani_disappearing = false;
@@ -2006,7 +2434,7 @@ void InteractiveButtonBase::anchorTimeOut()
     // ==== 按下动画 ====
     if (click_ani_disappearing) // 点击动画效果消失
     {
-        qint64 delta = getTimestamp()-release_timestamp-click_ani_duration;
+        qint64 delta = timestamp-release_timestamp-click_ani_duration;
         if (delta <= 0) click_ani_progress = 100;
         else click_ani_progress = static_cast<int>(100 - delta*100 / click_ani_duration);
         if (click_ani_progress < 0)
@@ -2018,7 +2446,7 @@ void InteractiveButtonBase::anchorTimeOut()
     }
     if (click_ani_appearing) // 点击动画效果
     {
-        qint64 delta = getTimestamp()-release_timestamp;
+        qint64 delta = timestamp-release_timestamp;
         if (delta <= 0) click_ani_progress = 0;
         else click_ani_progress = static_cast<int>(delta * 100 / click_ani_duration);
         if (click_ani_progress > 100)
@@ -2036,7 +2464,7 @@ void InteractiveButtonBase::anchorTimeOut()
         // 当前应该是处在最后一个点
         Jitter cur = jitters.first();
         Jitter aim = jitters.at(1);
-        int del = static_cast<int>(getTimestamp()-cur.timestamp);
+        int del = static_cast<int>(timestamp-cur.timestamp);
         int dur = static_cast<int>(aim.timestamp - cur.timestamp);
         effect_pos = cur.point + (aim.point-cur.point)*del/dur;
         offset_pos = effect_pos- (geometry().center() - geometry().topLeft());
@@ -2053,11 +2481,20 @@ void InteractiveButtonBase::anchorTimeOut()
     }
     else if (anchor_pos != mouse_pos) // 移动效果
     {
-        int delta_x = anchor_pos.x() - mouse_pos.x(),
-            delta_y = anchor_pos.y() - mouse_pos.y();
+        // 每 anchor_interval 毫秒靠近一次，经过的时间不足一次的留到下一帧
+        anchor_carry += elapsed;
+        int steps = static_cast<int>(qMin(anchor_carry / anchor_interval, static_cast<qint64>(100)));
+        anchor_carry -= steps * anchor_interval;
+        while (steps-- > 0 && anchor_pos != mouse_pos)
+        {
+            int delta_x = anchor_pos.x() - mouse_pos.x(),
+                delta_y = anchor_pos.y() - mouse_pos.y();
 
-        anchor_pos.setX( anchor_pos.x() - quick_sqrt(delta_x) );
-        anchor_pos.setY( anchor_pos.y() - quick_sqrt(delta_y) );
+            anchor_pos.setX( anchor_pos.x() - quick_sqrt(delta_x) );
+            anchor_pos.setY( anchor_pos.y() - quick_sqrt(delta_y) );
+        }
+        if (anchor_pos == mouse_pos)
+            anchor_carry = 0;
 
         offset_pos.setX(quick_sqrt(static_cast<long>(anchor_pos.x()-(geometry().width()>>1))));
         offset_pos.setY(quick_sqrt(static_cast<long>(anchor_pos.y()-(geometry().height()>>1))));
@@ -2068,7 +2505,11 @@ void InteractiveButtonBase::anchorTimeOut()
              && !click_ani_appearing && !click_ani_disappearing && !jitters.size() && !waters.size()
              && !show_ani_appearing && !show_ani_disappearing) // 没有需要加载的项，暂停（节约资源）
     {
-        anchor_timer->stop();
+        FrameScheduler::instance()->unsubscribe(this);
+        anchor_timestamp = 0; // 下次开始时重新计时
+        anchor_carry = 0;
+        hover_carry = press_carry = 0;
+        invalidateLayers(); // 静止时不占用图层内存
     }
 
     // ==== 统一坐标的出现动画 ====
@@ -2077,6 +2518,7 @@ void InteractiveButtonBase::anchorTimeOut()
         updateUnifiedGeometry();
     }
 
+    PERF_TICK(perf_counters, aniState() != ani_state);
     update();
 }
 
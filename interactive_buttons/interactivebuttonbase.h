@@ -13,7 +13,13 @@
 #include <QDateTime>
 #include <QList>
 #include <QBitmap>
+#include <QWindow>
 #include <QtMath>
+#include "framescheduler.h"
+#include "animationclock.h"
+#include "perfcounters.h"
+#include "tracerecorder.h"
+#include "tintedpixmapcache.h"
 
 #define PI 3.1415926
 #define GOLDEN_RATIO 0.618
@@ -35,7 +41,7 @@
  * 程序版权归作者所有，只可使用不能出售，违反者本人有权追究责任。
  */
 
-class InteractiveButtonBase : public QPushButton
+class InteractiveButtonBase : public QPushButton, public FrameClient
 {
     Q_OBJECT
     Q_PROPERTY(bool self_enabled READ getSelfEnabled WRITE setSelfEnabled)                      // 是否启用自定义的按钮（true）
@@ -91,8 +97,9 @@ public:
     struct PaintAddin
     {
         PaintAddin() : enable(false) {}
-        PaintAddin(QPixmap p, Qt::Alignment a, QSize s) : enable(true), pixmap(p), align(a), size(s) {}
+        PaintAddin(QPixmap p, Qt::Alignment a, QSize s) : enable(true), origin(p), pixmap(p), align(a), size(s) {}
         bool enable;         // 是否启用
+        QPixmap origin;      // 原图，变色时从原图着色
         QPixmap pixmap;      // 可变色图标
         Qt::Alignment align; // 对齐方式
         QSize size;          // 固定大小
@@ -196,6 +203,8 @@ public:
     void setAutoTextColor(bool a = true);
     void setPretendFocus(bool f = true);
     void setBlockHover(bool b = true);
+    void setLayerCache(bool enable = true);
+    void setFontScaleAni(bool enable = true);
 
     void setShowAni(bool enable = true);
     void showForeground();
@@ -252,10 +261,29 @@ protected:
     void focusOutEvent(QFocusEvent *event) override;
     void changeEvent(QEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void frameTick() override;
+    void subscribeFrames();
+    void suspendAnimations();
+    void resumeAnimations();
 
     virtual bool inArea(QPoint point);
     virtual QPainterPath getBgPainterPath();
     virtual QPainterPath getWaterPainterPath(Water water);
+    const QPainterPath& getCachedBgPath();
+    void invalidateBgPath();
+    void paintBackground(QPainter& painter);
+    void paintForeground(QPainter& painter, const QRect& rect);
+    void drawScaledText(QPainter& painter, const QRect& rect, Qt::Alignment a);
+    QRect getForeRestRect();
+    QImage createLayer();
+    const QImage& getBgLayer();
+    const QImage& getForeLayer();
+    QRect getAddinRect();
+    const QImage& getAddinLayer(const QSize& size);
+    void invalidateLayers();
     virtual void drawIconBeforeText(QPainter &painter, QRect icon_rect);
 
     QRect getUnifiedGeometry();
@@ -308,6 +336,7 @@ protected:
     QIcon icon;
     QString text;
     QPixmap pixmap;
+    QPixmap pixmap_origin; // 原图，变色时从原图着色（透明度不会累积）
     PaintAddin paint_addin;
     EdgeVal fore_paddings;
 
@@ -332,9 +361,15 @@ protected:
     qint64 hover_timestamp, leave_timestamp, press_timestamp, release_timestamp; // 各种事件的时间戳
     int hover_bg_duration, press_bg_duration, click_ani_duration;                // 各种动画时长
 
-    // 定时刷新界面（保证动画持续）
-    QTimer *anchor_timer;
+    // 定时刷新界面（保证动画持续），使用全局共享的帧时钟
     int move_speed;
+    int anchor_interval;     // 各种速度对应的时间间隔（毫秒），动画按经过的时间推进
+    qint64 anchor_timestamp; // 上一帧的时间戳
+    qint64 anchor_carry;     // 锚点移动还没用完的时间
+    double hover_carry, press_carry; // 悬浮、按下进度取整后剩下的小数部分
+    bool ani_suspended;      // 看不见时暂停，时间停在 suspend_timestamp
+    bool ani_resume;         // 恢复时需要重新订阅帧时钟
+    qint64 suspend_timestamp;
 
     // 背景与前景
     QColor icon_color, text_color;                   // 前景颜色
@@ -346,7 +381,57 @@ protected:
     int icon_text_padding, icon_text_size;           // 图标+文字模式共存时，两者间隔、图标大小
     int border_width;
     int radius_x, radius_y;
+    QPainterPath bg_path; // 背景区域缓存，尺寸、圆角改变时重新生成
+    bool bg_path_dirty;
+
+    // 动画中的分层缓存：不变的背景（默认、焦点、边框）、额外内容与静止位置的图标
+    // 内容与 key 相同时直接贴图，动画结束后释放；文字始终直接绘制
+    struct BgLayerKey
+    {
+        QSize size;
+        qreal dpr = 0;
+        bool enabled = false, focusing = false;
+        QRgb normal = 0, focus = 0, focus_border = 0, border = 0;
+        int border_width = 0;
+        bool operator==(const BgLayerKey& o) const
+        {
+            return size == o.size && dpr == o.dpr && enabled == o.enabled && focusing == o.focusing
+                    && normal == o.normal && focus == o.focus && focus_border == o.focus_border
+                    && border == o.border && border_width == o.border_width;
+        }
+    };
+    struct ForeLayerKey
+    {
+        int model = -1;
+        QSize size;
+        qreal dpr = 0;
+        QRect rect;
+        Qt::Alignment align;
+        qint64 icon_key = 0;
+        int icon_mode = 0;
+        qint64 pixmap_key = 0;
+        bool operator==(const ForeLayerKey& o) const
+        {
+            return model == o.model && size == o.size && dpr == o.dpr && rect == o.rect && align == o.align
+                    && icon_key == o.icon_key && icon_mode == o.icon_mode && pixmap_key == o.pixmap_key;
+        }
+    };
+    bool layer_cache;
+    QImage bg_layer, fore_layer;
+    QImage addin_layer;     // 缩放好的额外内容
+    qint64 addin_layer_key;
+    QSize addin_layer_size;
+    BgLayerKey bg_layer_key;
+    ForeLayerKey fore_layer_key;
     int font_size;
+    bool font_scale_ani;      // 字体动画使用缩放，不逐帧 setFont
+    int font_scale_size;      // 缩放动画中绘制文字的字号（两端中较大的），0 表示不在动画中
+    QImage font_scale_image;  // 按 font_scale_size 绘制好的文字
+    QString font_scale_text;
+    QRgb font_scale_color;
+    int font_scale_image_size; // 绘制 font_scale_image 时的字号
+    QFont font_scale_font;
+    QPropertyAnimation* font_size_ani; // 正在进行的字体大小动画
     bool fixed_fore_pos;    // 鼠标进入时是否固定文字位置
     bool fixed_fore_size;   // 鼠标进入/点击时是否固定前景大小
     bool text_dynamic_size; // 设置字体时自动调整最小宽高
@@ -384,6 +469,10 @@ protected:
     bool double_clicked;  // 开启双击
     QTimer *double_timer; // 双击时钟
     bool double_prevent;  // 双击阻止单击release的flag
+
+#ifdef WIDGET_PERF_COUNTERS
+    PerfCounters perf_counters{this};
+#endif
 };
 
 #endif // INTERACTIVEBUTTONBASE_H
@@ -0,0 +1,113 @@
+#include "tintedpixmapcache.h"
+#include <QHash>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TINTEDPIXMAP_SSE2
+#endif
+
+quint64 TintedPixmapCache::hits = 0;
+quint64 TintedPixmapCache::misses = 0;
+
+static inline uint div255(uint x)
+{
+    return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+uint qHash(const TintedPixmapCache::Key& key, uint seed)
+{
+    return qHash(key.cache_key, seed) ^ qHash(key.rgba, seed)
+            ^ qHash((key.size.width() << 16) ^ key.size.height(), seed) ^ qHash(qRound(key.dpr * 100), seed);
+}
+
+/**
+ * 缓存上限，单位 KB，默认 4MB
+ */
+QCache<TintedPixmapCache::Key, QPixmap> &TintedPixmapCache::cache()
+{
+    static QCache<Key, QPixmap> pixmaps(4096);
+    return pixmaps;
+}
+
+/**
+ * 获取对应颜色的图标
+ * 保留原图每个像素的透明度（边缘抗锯齿），颜色全部替换为 color
+ */
+QPixmap TintedPixmapCache::tinted(const QPixmap &source, const QColor &color)
+{
+    if (source.isNull())
+        return source;
+
+    const Key key{ source.cacheKey(), color.rgba(), source.size(), source.devicePixelRatioF() };
+    if (QPixmap* pixmap = cache().object(key))
+    {
+        hits++;
+        return *pixmap;
+    }
+    misses++;
+
+    QImage image = source.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    tint(image, color);
+    QPixmap* pixmap = new QPixmap(QPixmap::fromImage(image));
+    pixmap->setDevicePixelRatio(source.devicePixelRatioF());
+    const QPixmap result = *pixmap;
+    cache().insert(key, pixmap, qMax(1, image.bytesPerLine() * image.height() / 1024));
+    return result;
+}
+
+/**
+ * 着色：每个像素 = 预乘后的颜色 × 原像素透明度
+ * 每次处理4个像素，16位乘法后用 (x + 128 + ((x + 128) >> 8)) >> 8 近似除以255
+ * @param image 必须是 Format_ARGB32_Premultiplied
+ */
+void TintedPixmapCache::tint(QImage &image, const QColor &color)
+{
+    Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+    const QRgb premul = qPremultiply(color.rgba());
+    const int width = image.width();
+    const int height = image.height();
+
+#ifdef TINTEDPIXMAP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(premul)), zero); // 两个像素的ARGB，各16位
+#endif
+    for (int y = 0; y < height; y++)
+    {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        int x = 0;
+#ifdef TINTEDPIXMAP_SSE2
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + x));
+            // 每个像素的透明度铺满四个通道
+            __m128i alpha = _mm_srli_epi32(pixels, 24);
+            alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+            __m128i alpha_lo = _mm_unpacklo_epi32(alpha, alpha);
+            __m128i alpha_hi = _mm_unpackhi_epi32(alpha, alpha);
+
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(color16, alpha_lo), round);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(color16, alpha_hi), round);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line + x), _mm_packus_epi16(lo, hi));
+        }
+#endif
+        for (; x < width; x++)
+        {
+            const uint alpha = qAlpha(line[x]);
+            line[x] = qRgba(div255(qRed(premul) * alpha), div255(qGreen(premul) * alpha),
+                            div255(qBlue(premul) * alpha), div255(qAlpha(premul) * alpha));
+        }
+    }
+}
+
+void TintedPixmapCache::clear()
+{
+    cache().clear();
+}
+
+void TintedPixmapCache::setCapacity(int kb)
+{
+    cache().setMaxCost(kb);
+}
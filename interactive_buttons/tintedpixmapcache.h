@@ -0,0 +1,45 @@
+#ifndef TINTEDPIXMAPCACHE_H
+#define TINTEDPIXMAPCACHE_H
+
+#include <QPixmap>
+#include <QImage>
+#include <QColor>
+#include <QCache>
+
+/**
+ * 可变色图标的着色与缓存（全进程共用）
+ * 按 (原图 cacheKey, 颜色, 尺寸, 设备像素比) 缓存着色结果，
+ * 切换主题时大量按钮使用同一个图标，只需要着色一次
+ * 只在界面线程中使用
+ */
+class TintedPixmapCache
+{
+public:
+    static QPixmap tinted(const QPixmap& source, const QColor& color);
+    static void tint(QImage& image, const QColor& color);
+
+    static void clear();
+    static void setCapacity(int kb);
+    static quint64 hitCount() { return hits; }
+    static quint64 missCount() { return misses; }
+
+private:
+    struct Key
+    {
+        qint64 cache_key;
+        QRgb rgba;
+        QSize size;
+        qreal dpr;
+        bool operator==(const Key& o) const
+        {
+            return cache_key == o.cache_key && rgba == o.rgba && size == o.size && dpr == o.dpr;
+        }
+    };
+    friend uint qHash(const Key& key, uint seed);
+
+    static QCache<Key, QPixmap>& cache();
+    static quint64 hits;
+    static quint64 misses;
+};
+
+#endif // TINTEDPIXMAPCACHE_H
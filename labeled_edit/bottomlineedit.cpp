@@ -26,6 +26,14 @@ void BottomLineEdit::setViewShowed(bool show)
     update();
 }
 
+/**
+ * 光标的位置，用于推算内容横向滚动了多少
+ */
+QRect BottomLineEdit::cursorGeometry() const
+{
+    return cursorRect();
+}
+
 void BottomLineEdit::focusInEvent(QFocusEvent *e)
 {
     QLineEdit::focusInEvent(e);
@@ -42,5 +50,6 @@ void BottomLineEdit::paintEvent(QPaintEvent *e)
 {
     if (!show_view)
         return ;
+    PERF_PAINT_SCOPE(perf_counters);
     QLineEdit::paintEvent(e);
 }
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QLineEdit>
+#include "perfcounters.h"
 
 class BottomLineEdit : public QLineEdit
 {
@@ -11,6 +12,7 @@ public:
     BottomLineEdit(QWidget* parent = nullptr);
 
     void setViewShowed(bool show);
+    QRect cursorGeometry() const;
 
 protected:
     void focusInEvent(QFocusEvent *e) override;
@@ -31,6 +33,10 @@ private:
     // 方案2：设置NoEcho
     // 优缺点与上面相反
     QLineEdit::EchoMode real_echo = EchoMode::Normal;
+
+#ifdef WIDGET_PERF_COUNTERS
+    PerfCounters perf_counters{this};
+#endif
 };
 
 #endif // BOTTOMLINEEDIT_H
@@ -1,4 +1,122 @@
 #include "labelededit.h"
+#include <QtConcurrent>
+#include <QTextBoundaryFinder>
+#include <algorithm>
+
+/**
+ * 从排版好的一行中取出每个字符左边相对于起点的偏移
+ * 已包含字距调整，代理对的后半个和前半个位置相同
+ * 最后多一项是总宽度
+ */
+static void lineAdvances(const QTextLine& line, int length, QVector<qreal>* advances)
+{
+    advances->resize(length + 1);
+    for (int i = 0; i <= length; i++)
+        (*advances)[i] = line.isValid() ? line.cursorToX(i) : 0;
+}
+
+/**
+ * 把字形的位置平移到以 origin 为原点
+ */
+static void moveGlyphRuns(QList<QGlyphRun>& runs, const QPointF& origin)
+{
+    for (int i = 0; i < runs.size(); i++)
+    {
+        QVector<QPointF> poss = runs.at(i).positions();
+        for (int j = 0; j < poss.size(); j++)
+            poss[j] -= origin;
+        runs[i].setPositions(poss);
+    }
+}
+
+/**
+ * 排版一段文字，得到以左侧基线为原点的字形
+ * 绘制时只需要平移，不需要每次重新排版
+ * @param advances 可选，输出每个字符左边相对于起点的偏移，最后一项是总宽度
+ */
+static QList<QGlyphRun> shapeGlyphRuns(const QString& text, const QFont& font, QVector<qreal>* advances = nullptr)
+{
+    QTextLayout layout(text, font);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    if (line.isValid())
+        line.setNumColumns(text.length());
+    layout.endLayout();
+    if (advances)
+        lineAdvances(line, text.length(), advances);
+    if (!line.isValid())
+        return QList<QGlyphRun>();
+
+    QList<QGlyphRun> runs = layout.glyphRuns();
+    moveGlyphRuns(runs, QPointF(0, line.ascent()));
+    return runs;
+}
+
+/**
+ * 把标签拆成字形簇（用户看到的一个字），代理对、组合字符不会被拆开
+ * @return 每个字形簇的起始位置，最后一项是文字长度
+ */
+static QVector<int> graphemeClusters(const QString& text)
+{
+    QVector<int> clusters;
+    clusters.append(0);
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Grapheme, text);
+    while (clusters.last() < text.length())
+    {
+        int next = finder.toNextBoundary();
+        if (next <= clusters.last())
+            next = text.length();
+        clusters.append(next);
+    }
+    return clusters;
+}
+
+/**
+ * 整体排版后按字形簇拆开字形，每个字形簇以自己左侧基线为原点
+ * 字形来自整行的排版，连写等上下文相关的字形和整体绘制时一致
+ */
+static QList<QList<QGlyphRun>> shapeClusterRuns(const QString& text, const QFont& font, const QVector<int>& clusters)
+{
+    QTextLayout layout(text, font);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    if (line.isValid())
+        line.setNumColumns(text.length());
+    layout.endLayout();
+
+    QList<QList<QGlyphRun>> cluster_runs;
+    for (int i = 0; i + 1 < clusters.size(); i++)
+    {
+        QList<QGlyphRun> runs;
+        if (line.isValid())
+        {
+            const int from = clusters.at(i);
+            runs = layout.glyphRuns(from, clusters.at(i + 1) - from);
+            moveGlyphRuns(runs, QPointF(line.cursorToX(from), line.ascent()));
+        }
+        cluster_runs.append(runs);
+    }
+    return cluster_runs;
+}
+
+/**
+ * 在基线位置绘制排版好的字形
+ */
+static void drawGlyphRuns(QPainter& painter, const QPointF& pos, const QList<QGlyphRun>& runs)
+{
+    for (int i = 0; i < runs.size(); i++)
+        painter.drawGlyphRun(pos, runs.at(i));
+}
+
+#ifdef WIDGET_TRACING
+/**
+ * 时间线上显示的动画名称，顺序与 AniChannel 一致
+ */
+static const char* const channel_names[] = {
+    "LabelProg", "FocusProg", "LosesProg", "WrongProg", "CorrectProg",
+    "ShowLoadingProg", "HideLoadingProg", "TipProg", "MsgShowProg", "MsgHideProg"
+};
+#endif
 
 LabeledEdit::LabeledEdit(QWidget *parent) : QWidget(parent)
 {
@@ -12,38 +130,42 @@ LabeledEdit::LabeledEdit(QWidget *parent) : QWidget(parent)
     layout->addWidget(line_edit);
     layout->addWidget(down_spacer);
     layout->setSpacing(0);
+    layout->setMargin(0);
 
     up_spacer->setMinimumWidth(1);
     down_spacer->setMinimumWidth(1);
 
     connect(line_edit, &BottomLineEdit::signalFocusIn, this, [=]{
-        connect(startAnimation("FocusProg", getFocusProg(), 100, focus_duration, QEasingCurve::OutQuad), &QPropertyAnimation::finished, this, [=]{
-            loses_prog = 0;
-        });
+        startAnimation(FocusChannel, getFocusProg(), 100, focus_duration, QEasingCurve::OutQuad);
         upperLabel();
     });
     connect(line_edit, &BottomLineEdit::signalFocusOut, this, [=]{
         if (line_edit->hasFocus()) // 比如右键菜单，还是算作聚焦的
             return ;
-        connect(startAnimation("LosesProg", getLosesProg(), 100, focus_duration, QEasingCurve::OutQuad), &QPropertyAnimation::finished, this, [=]{
-            if (!line_edit->hasFocus())
-                focus_prog = 0;
-            loses_prog = 0;
-        });
+        startAnimation(LosesChannel, getLosesProg(), 100, focus_duration, QEasingCurve::OutQuad);
         if (line_edit->text().isEmpty())
             innerLabel();
     });
+
+    // 同一帧（或节流时间）内的多次编辑合并成一次状态切换，在帧时钟中执行
     connect(line_edit, &BottomLineEdit::textEdited, this, [=]{
-        if (correct_prog)
+        if (edit_throttle == 0 || ani_suspended) // 不合并；看不见时没有帧时钟
+            return editTransition();
+        if (edit_pending)
         {
-            startAnimation("CorrectProg", getCorrectProg(), 0, correct_duration, QEasingCurve::Linear);
-        }
-        if (autoClearMsg && !msg_text.isEmpty())
-        {
-            hideMsg();
+            suppressed_transitions++;
+            return ;
         }
+        edit_pending = true;
+        edit_time = AnimationClock::now();
+        FrameScheduler::instance()->subscribe(this);
     });
 
+    validate_timer = new QTimer(this);
+    validate_timer->setSingleShot(true);
+    validate_timer->setInterval(300);
+    connect(validate_timer, &QTimer::timeout, this, &LabeledEdit::validate);
+
     grayed_color = Qt::gray;
     accent_color = QColor(198, 47, 47);
 
@@ -64,43 +186,68 @@ BottomLineEdit *LabeledEdit::editor()
 
 /**
  * 修改控件大小或者字体大小后，调整各种间距与位置
+ * 按（字体、标签、输入框位置）缓存，只重新计算发生变化的部分
  */
 void LabeledEdit::adjustBlank()
 {
-    // 计算四周的空白
+    TRACE_SCOPE("LabeledEdit", "adjustBlank");
     QFont nft = line_edit->font();
-    QFontMetricsF nfm(nft);
-    double label_nh = nfm.height();
-    QFont sft = nft;
-    sft.setPointSizeF(sft.pointSize() / label_scale);
-    QFontMetricsF sfm(sft);
-    double label_sh = sfm.height();
-    double wave_h = nfm.height() * 2 / 3;
-
     QRect geom = line_edit->geometry();
-    double big_margin = (geom.height() - label_nh) / 2;
-    double small_margin = big_margin / label_scale;
+    const bool text_changed = !layout_valid || layout_text != label_text || layout_font != nft;
+    if (!text_changed && layout_geom == geom) // 什么都没变
+        return ;
+    relayout_count++;
 
-    up_spacer->setMinimumHeight(static_cast<int>(label_sh * label_scale));
-    down_spacer->setMinimumHeight(static_cast<int>(wave_h));
-    line_edit->setMinimumHeight(static_cast<int>(nfm.lineSpacing() + pen_width));
-    this->setMinimumHeight(up_spacer->minimumHeight() + down_spacer->minimumHeight() + line_edit->minimumHeight());
-    layout()->setMargin(0);
+    if (text_changed)
+    {
+        layout_valid = true;
+        layout_text = label_text;
+        layout_font = nft;
+
+        // 计算四周的空白
+        QFontMetricsF nfm(nft);
+        QFont sft = nft;
+        sft.setPointSizeF(sft.pointSize() / label_scale);
+        QFontMetricsF sfm(sft);
+        label_nh = nfm.height();
+        double label_sh = sfm.height();
+        double wave_h = nfm.height() * 2 / 3;
+
+        // 只在数值变化时修改，避免触发额外的布局
+        auto setMinHeight = [](QWidget* w, int h) {
+            if (w->minimumHeight() != h)
+                w->setMinimumHeight(h);
+        };
+        setMinHeight(up_spacer, static_cast<int>(label_sh * label_scale));
+        setMinHeight(down_spacer, static_cast<int>(wave_h));
+        setMinHeight(line_edit, static_cast<int>(nfm.lineSpacing() + pen_width));
+        setMinHeight(this, up_spacer->minimumHeight() + down_spacer->minimumHeight() + line_edit->minimumHeight());
+
+        // 缓存排版好的字形与每个字符的偏移，只有标签或字体改变时才重新排版
+        label_in_runs = shapeGlyphRuns(label_text, nft, &label_in_advances);
+        label_up_runs = shapeGlyphRuns(label_text, sft, &label_up_advances);
+        label_clusters = graphemeClusters(label_text);
+        label_in_char_runs = shapeClusterRuns(label_text, nft, label_clusters);
+        label_up_char_runs = shapeClusterRuns(label_text, sft, label_clusters);
+
+        geom = line_edit->geometry(); // 上面修改最小高度可能已经改变了位置
+    }
+    layout_geom = geom;
 
     // 缓存文字的位置
+    double big_margin = (geom.height() - label_nh) / 2;
+    double small_margin = big_margin / label_scale;
     label_in_poss.clear();
     label_up_poss.clear();
     QPointF in_pos(geom.left() + big_margin, geom.bottom() - big_margin);
     QPointF up_pos(geom.left() + small_margin, geom.top() - small_margin);
     label_in_poss.append(in_pos);
     label_up_poss.append(up_pos);
-    for (int i = 1; i < label_text.size(); i++)
+    for (int i = 1; i + 1 < label_clusters.size(); i++)
     {
-        QString t = label_text.left(i);
-        double in_w = nfm.horizontalAdvance(t);
-        double up_w = sfm.horizontalAdvance(t);
-        label_in_poss.append(QPointF(in_pos + QPointF(in_w, 0)));
-        label_up_poss.append(QPointF(up_pos + QPointF(up_w, 0)));
+        const int from = label_clusters.at(i);
+        label_in_poss.append(QPointF(in_pos + QPointF(label_in_advances.at(from), 0)));
+        label_up_poss.append(QPointF(up_pos + QPointF(label_up_advances.at(from), 0)));
     }
 
     // 菊花的位置
@@ -109,6 +256,14 @@ void LabeledEdit::adjustBlank()
     loading_rect = QRectF(geom.right() - label_nh, geom.bottom() - label_nh, label_nh, label_nh).toRect();
 }
 
+/**
+ * 重新计算布局的次数（调试性能用）
+ */
+int LabeledEdit::relayoutCount() const
+{
+    return relayout_count;
+}
+
 QString LabeledEdit::text()
 {
     return line_edit->text();
@@ -171,20 +326,26 @@ void LabeledEdit::setAccentColor(QColor color)
 
 void LabeledEdit::showCorrect()
 {
+    TRACE_SCOPE("LabeledEdit", "showCorrect");
     if (show_loading_prog)
         hideLoading();
     // 错误与正确只能选一个
-    wrong_prog = 0;
-    startAnimation("CorrectProg", getCorrectProg(), 100, correct_duration, QEasingCurve::Linear);
+    if (wrong_prog)
+    {
+        wrong_prog = 0;
+        update(); // 波浪线覆盖整个控件
+    }
+    startAnimation(CorrectChannel, getCorrectProg(), 100, correct_duration, QEasingCurve::Linear);
 }
 
 void LabeledEdit::hideCorrect()
 {
-    startAnimation("CorrectProg", getCorrectProg(), 0, correct_duration, QEasingCurve::OutQuad);
+    startAnimation(CorrectChannel, getCorrectProg(), 0, correct_duration, QEasingCurve::OutQuad);
 }
 
 void LabeledEdit::showWrong()
 {
+    TRACE_SCOPE("LabeledEdit", "showWrong");
     if (show_loading_prog)
         hideLoading();
     if (tip_prog)
@@ -192,17 +353,10 @@ void LabeledEdit::showWrong()
 
     // 开始动画
     correct_prog = 0;
+    if (wrong_wave_mode == SnapshotWave && !wrong_prog) // 输入框隐藏之前截图
+        captureWaveSnapshot();
     wrong_prog = qMax(wrong_prog, 1); // 从1开始，避免隐藏输入框而0又不显示文字导致的文字闪动
-    connect(startAnimation("WrongProg", wrong_prog, 100, wrong_duration, QEasingCurve::OutQuad), &QPropertyAnimation::finished, this, [=]{
-        // 只显示波浪线一次
-        wrong_prog = 0;
-        line_edit->setViewShowed(true);
-        // 恢复隐藏的提示
-        if (!msg_text.isEmpty())
-            showMsg();
-        else if (entering)
-            showTip();
-    });
+    startAnimation(WrongChannel, wrong_prog, 100, wrong_duration, QEasingCurve::OutQuad);
     // 隐藏现有文字
     line_edit->setViewShowed(false);
 
@@ -221,68 +375,384 @@ void LabeledEdit::showWrong(QString msg, bool autoClear)
 
 void LabeledEdit::showLoading()
 {
+    TRACE_SCOPE("LabeledEdit", "showLoading");
     if (correct_prog)
         hideCorrect();
     if (!msg_text.isEmpty())
         hideMsg();
 
-    if (loading_timer == nullptr)
+    if (!loading_running)
     {
-        loading_timer = new QTimer(this);
-        loading_timer->setInterval(80);
-        connect(loading_timer, &QTimer::timeout, this, [=]{
-            loading_index++;
-            update();
-//          repaint(loading_rect);
-        });
+        loading_running = true;
+        loading_start_time = aniNow() - loading_index * loading_interval; // 接着上次的花瓣继续转
+        if (!ani_suspended)
+            FrameScheduler::instance()->subscribe(this);
     }
-    loading_timer->start();
-    connect(startAnimation("ShowLoadingProg", getShowLoadingProg(), 100, show_loading_duration, QEasingCurve::QEasingCurve::OutBack), &QPropertyAnimation::finished, this, [=]{
-        if (hide_loading_prog > 90) // 如果loading正在show然后马上hide，那么会hide先结束，然后再show结束，导致一直显示
-            show_loading_prog = 0;
-    });
+    startAnimation(ShowLoadingChannel, getShowLoadingProg(), 100, show_loading_duration, QEasingCurve::OutBack);
 }
 
 void LabeledEdit::hideLoading()
 {
-    connect(startAnimation("HideLoadingProg", getHideLoadingProg(), 100, hide_loading_duration, QEasingCurve::OutQuad), &QPropertyAnimation::finished, this, [=]{
-        if (show_loading_prog == 100)
-            hide_loading_prog = 0;
-        show_loading_prog = 0;
-        if (loading_timer)
-            loading_timer->stop();
+    startAnimation(HideLoadingChannel, getHideLoadingProg(), 100, hide_loading_duration, QEasingCurve::OutQuad);
+}
+
+/**
+ * 错误波浪线经过时文字的绘制方式
+ * 内容很长或者输入框设置了 QSS 样式时，建议使用 SnapshotWave
+ */
+void LabeledEdit::setWrongWaveMode(WrongWaveMode mode)
+{
+    this->wrong_wave_mode = mode;
+    if (mode != SnapshotWave)
+        wave_snapshot = QImage();
+}
+
+/**
+ * 错误动画开始时，把标签和输入框的内容（包括 QSS 样式）绘制到图片中
+ * 之后每一帧只需要把图片按列上下平移
+ */
+void LabeledEdit::captureWaveSnapshot()
+{
+    const qreal dpr = devicePixelRatioF();
+    QImage image(size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setPen(QPen(grayed_color, 1));
+    wave_label_inside = line_edit->text().isEmpty() && !line_edit->hasFocus();
+    const QList<QList<QGlyphRun>>& runs = wave_label_inside ? label_in_char_runs : label_up_char_runs;
+    const QList<QPointF>& poss = wave_label_inside ? label_in_poss : label_up_poss;
+    for (int i = 0; i < runs.size() && i < poss.size(); i++)
+        drawGlyphRuns(painter, poss.at(i), runs.at(i));
+    if (!wave_label_inside)
+        line_edit->render(&painter, line_edit->pos(), QRegion(), QWidget::DrawChildren);
+    painter.end();
+
+    wave_snapshot = image;
+}
+
+/**
+ * 编辑后的状态切换：隐藏正确的勾、自动清除错误信息、检查规则、开始校验
+ * 连续快速的输入（扫码枪、输入法上屏、按住不放）只执行一次
+ */
+void LabeledEdit::editTransition()
+{
+    edit_pending = false;
+    if (correct_prog)
+    {
+        startAnimation(CorrectChannel, getCorrectProg(), 0, correct_duration, QEasingCurve::Linear);
+    }
+    if (autoClearMsg && !msg_text.isEmpty())
+    {
+        hideMsg();
+    }
+    const bool rule_passed = !rule_enabled || applyRule(line_edit->text());
+    if (validator)
+    {
+        supersedeValidation(); // 正在进行的校验已经过期
+        ValidationResult result;
+        if (!rule_passed) // 规则都不符合，不需要再校验
+        {
+            validate_timer->stop();
+        }
+        else if (validation_cache && validation_cache->find(line_edit->text(), &result))
+        {
+            // 校验过的内容立即显示结果
+            validate_timer->stop();
+            applyValidation(result);
+        }
+        else
+        {
+            validate_timer->start();
+        }
+    }
+    else if (rule_enabled && rule_passed)
+    {
+        applyValidation(ValidationResult(true));
+    }
+}
+
+/**
+ * 编辑后多久切换一次状态（毫秒），期间的编辑合并为一次
+ * @param ms -1（默认）：到下一帧再切换；0：每次编辑都立即切换；大于0：合并这么多毫秒内的编辑
+ *           小于-1 的按 -1 处理
+ */
+void LabeledEdit::setEditThrottle(int ms)
+{
+    edit_throttle = qMax(-1, ms);
+}
+
+/**
+ * 被合并掉的状态切换次数
+ */
+quint64 LabeledEdit::suppressedTransitions() const
+{
+    return suppressed_transitions;
+}
+
+/**
+ * 设置异步校验
+ * 用户编辑后（停止输入 setValidateDelay 毫秒）显示加载动画，校验完成后显示正确或错误
+ * 独享的缓存会清空；共用的缓存需要调用者 clear() 或者换一个
+ * @param validator 返回 QFuture 的函数，例如网络请求；为空则取消校验
+ */
+void LabeledEdit::setAsyncValidator(AsyncValidator validator)
+{
+    this->validator = validator;
+    if (validation_cache && validation_cache_owned) // 旧校验函数的结果不能用于新的
+        validation_cache->clear();
+    supersedeValidation();
+    validate_timer->stop();
+}
+
+/**
+ * 设置同步校验（正则、本地数据库查询等）
+ * 在线程池中运行，不会阻塞输入；注意函数中不能访问界面
+ * @param pool 线程池，默认使用全局线程池
+ */
+void LabeledEdit::setValidator(Validator validator, QThreadPool *pool)
+{
+    if (!validator)
+        return setAsyncValidator(nullptr);
+    setAsyncValidator([=](const QString& text) {
+        return QtConcurrent::run(pool ? pool : QThreadPool::globalInstance(), [=]{
+            return validator(text);
+        });
+    });
+}
+
+LabeledEdit::AsyncValidator LabeledEdit::getValidator() const
+{
+    return validator;
+}
+
+/**
+ * 设置输入规则（长度、允许的字符等）
+ * 每次编辑后立即检查，不符合时直接显示错误，不再运行 setValidator 的校验
+ * 没有设置提示文字时，使用规则生成的提示
+ */
+void LabeledEdit::setRule(const ValidationRule &rule)
+{
+    this->rule = rule;
+    rule_enabled = true;
+    rule_failed = false;
+    if (tip_text.isEmpty())
+        setTipText(rule.tipText());
+}
+
+void LabeledEdit::clearRule()
+{
+    rule = ValidationRule();
+    rule_enabled = false;
+    rule_failed = false;
+}
+
+/**
+ * 当前的输入规则，没有设置时返回 nullptr
+ */
+const ValidationRule *LabeledEdit::getRule() const
+{
+    return rule_enabled ? &rule : nullptr;
+}
+
+/**
+ * 检查输入规则，不符合时立即显示错误
+ * 已经在显示错误时只更新错误信息，不重复播放波浪线
+ * @return 是否符合规则
+ */
+bool LabeledEdit::applyRule(const QString &text)
+{
+    ValidationResult result = rule.check(text);
+    if (result.valid)
+    {
+        if (rule_failed && !msg_text.isEmpty())
+            setMsgText("");
+        rule_failed = false;
+        return true;
+    }
+
+    if (!rule_failed)
+    {
+        showWrong(result.message);
+    }
+    else if (msg_text != result.message)
+    {
+        setMsgText(result.message);
+        if (!wrong_prog && !result.message.isEmpty()) // 波浪线结束后才会显示信息
+            showMsg();
+    }
+    rule_failed = true;
+    emit validated(text, result);
+    return false;
+}
+
+/**
+ * 停止输入多久后开始校验（毫秒）
+ */
+void LabeledEdit::setValidateDelay(int ms)
+{
+    validate_timer->setInterval(ms);
+}
+
+/**
+ * 缓存校验结果，相同的内容直接显示，不再显示加载动画和重新校验
+ * 相同规则的输入框可以共用一个缓存；修改规则或者 setValidator/setAsyncValidator 后
+ * 共用的缓存不会自动清空，需要 clear() 或者换一个新的缓存
+ * @param cache 为空则不缓存
+ */
+void LabeledEdit::setValidationCache(QSharedPointer<ValidationCache> cache)
+{
+    this->validation_cache = cache;
+    validation_cache_owned = false;
+}
+
+/**
+ * 使用自己独享的缓存
+ * @param capacity 最多缓存的数量，0 表示不缓存
+ */
+void LabeledEdit::setValidationCache(int capacity)
+{
+    if (capacity <= 0)
+        validation_cache.reset();
+    else
+        validation_cache.reset(new ValidationCache(capacity));
+    validation_cache_owned = true;
+}
+
+QSharedPointer<ValidationCache> LabeledEdit::getValidationCache() const
+{
+    return validation_cache;
+}
+
+/**
+ * 立即校验当前的内容
+ * 校验期间内容又改变了的话，结果会被丢弃
+ */
+void LabeledEdit::validate()
+{
+    validate_timer->stop();
+    edit_pending = false; // 合并中的编辑不需要再切换了
+    const QString text = line_edit->text();
+    if (rule_enabled && !applyRule(text))
+    {
+        supersedeValidation();
+        return ;
+    }
+    if (!validator)
+    {
+        if (rule_enabled)
+            applyValidation(ValidationResult(true));
+        return ;
+    }
+
+    ValidationResult cached;
+    if (validation_cache && validation_cache->find(text, &cached))
+    {
+        supersedeValidation();
+        return applyValidation(cached);
+    }
+    const quint64 serial = ++validate_serial;
+    validate_loading = true;
+    showLoading();
+
+    QFutureWatcher<ValidationResult>* watcher = new QFutureWatcher<ValidationResult>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [=]{
+        watcher->deleteLater();
+        const bool has_result = !watcher->isCanceled() && watcher->future().resultCount() > 0;
+        ValidationResult result;
+        if (has_result)
+        {
+            result = watcher->result();
+            if (validation_cache) // 过期的结果也可以留给以后使用
+                validation_cache->insert(text, result);
+        }
+        if (serial != validate_serial) // 已经被新的校验取代，加载动画由取代时处理
+            return ;
+
+        validate_loading = false;
+        if (!has_result || text != line_edit->text()) // 取消了，或者内容被程序修改了
+        {
+            if (show_loading_prog)
+                hideLoading();
+            return ;
+        }
+        applyValidation(result);
     });
+    watcher->setFuture(validator(text));
+}
+
+/**
+ * 正在进行的校验不再需要（结果会被丢弃）
+ * 由它显示的加载动画在这里隐藏，否则过期的结果返回时不会再处理
+ */
+void LabeledEdit::supersedeValidation()
+{
+    validate_serial++;
+    if (validate_loading)
+    {
+        validate_loading = false;
+        if (show_loading_prog)
+            hideLoading();
+    }
+}
+
+/**
+ * 取消等待中、进行中的校验（结果会被丢弃）
+ */
+void LabeledEdit::cancelValidate()
+{
+    validate_timer->stop();
+    edit_pending = false; // 合并中的编辑不再切换，否则会重新开始校验
+    supersedeValidation();
+}
+
+/**
+ * 显示校验结果：正确的勾，或者错误波浪线与信息
+ */
+void LabeledEdit::applyValidation(const ValidationResult &result)
+{
+    if (result.valid)
+    {
+        showCorrect();
+        setMsgText("");
+    }
+    else
+    {
+        showWrong(result.message, true);
+    }
+    emit validated(line_edit->text(), result);
 }
 
 void LabeledEdit::upperLabel()
 {
-    if (label_text.length() > label_ani_max)
-        startAnimation("LabelProg", getLabelProg(), 100, label_duration, QEasingCurve::Linear);
+    if (label_in_char_runs.size() > label_ani_max)
+        startAnimation(LabelChannel, getLabelProg(), 100, label_duration, QEasingCurve::Linear);
     else
-        startAnimation("LabelProg", getLabelProg(), 100, label_duration*2/3, QEasingCurve::OutCirc);
+        startAnimation(LabelChannel, getLabelProg(), 100, label_duration*2/3, QEasingCurve::OutCirc);
 }
 
 void LabeledEdit::innerLabel()
 {
-    if (label_text.length() > label_ani_max)
-        startAnimation("LabelProg", getLabelProg(), 0, label_duration, QEasingCurve::Linear);
+    if (label_in_char_runs.size() > label_ani_max)
+        startAnimation(LabelChannel, getLabelProg(), 0, label_duration, QEasingCurve::Linear);
     else
-        startAnimation("LabelProg", getLabelProg(), 0, label_duration*2/3, QEasingCurve::OutCirc);
+        startAnimation(LabelChannel, getLabelProg(), 0, label_duration*2/3, QEasingCurve::OutCirc);
 }
 
 void LabeledEdit::showTip()
 {
-    startAnimation("TipProg", getTipProg(), 100, tip_duration, QEasingCurve::InQuad);
+    startAnimation(TipChannel, getTipProg(), 100, tip_duration, QEasingCurve::InQuad);
 }
 
 void LabeledEdit::hideTip()
 {
-    startAnimation("TipProg", getTipProg(), 0, tip_duration, QEasingCurve::InQuad);
+    startAnimation(TipChannel, getTipProg(), 0, tip_duration, QEasingCurve::InQuad);
 }
 
 void LabeledEdit::showMsg()
 {
-    startAnimation("MsgShowProg", getMsgShowProg(), 100, msg_show_duration, QEasingCurve::OutQuad);
+    startAnimation(MsgShowChannel, getMsgShowProg(), 100, msg_show_duration, QEasingCurve::OutQuad);
 }
 
 /**
@@ -296,22 +766,22 @@ void LabeledEdit::hideMsg()
     msg_show_prog = 0;
     if (getMsgHideProg() == 0)
         setMsgHideProg(1);
-    connect(startAnimation("MsgHideProg", getMsgHideProg(), 100, msg_hide_duration, QEasingCurve::OutQuad), &QPropertyAnimation::finished, this, [=]{
-        // 只隐藏一次就清空
-        msg_hide_prog = 0;
-        msg_hiding = "";
-    });
+    startAnimation(MsgHideChannel, getMsgHideProg(), 100, msg_hide_duration, QEasingCurve::OutQuad);
 }
 
 void LabeledEdit::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
     adjustBlank();
+    wave_snapshot = QImage(); // 位置已经不对了，改为逐字绘制
 }
 
-void LabeledEdit::paintEvent(QPaintEvent *)
+void LabeledEdit::paintEvent(QPaintEvent *event)
 {
+    PERF_PAINT_SCOPE(perf_counters);
+    TRACE_SCOPE("LabeledEdit", "paintEvent");
     QPainter painter(this);
+    const QRect dirty = event->rect(); // 只重绘需要更新的部分
 //    painter.drawRect(0,0,width()-1,height()-1); // 测试边距
 
     // 绘制标签
@@ -322,274 +792,37 @@ void LabeledEdit::paintEvent(QPaintEvent *)
     const int line_top = geom.bottom(), line_width = geom.width();
     if (!wrong_prog)
     {
-        auto paintLine = [&]{
-            // 绘制普通下划线
-            painter.setPen(QPen(grayed_color, 1, Qt::SolidLine, Qt::RoundCap));
-            painter.drawLine(line_left, line_top, line_right, line_top);
-
-            // 绘制高亮下划线
-            if (focus_prog || loses_prog)
-            {
-                int w = line_width * focus_prog / 100;
-                int l = line_left + line_width * loses_prog / 100;
-                painter.setPen(QPen(accent_color, pen_width));
-                painter.drawLine(l, line_top, line_left + w, line_top);
-            }
-        };
-
-        // 绘制勾
-        if (!correct_prog) // 普通下划线
+        // 静止时（标签、下划线、勾都不在动画中）直接贴上缓存的图片
+        if (chrome_cache && isChromeResting())
         {
-            paintLine();
+            const QPixmap& chrome = getChromePixmap();
+            const qreal dpr = chrome.devicePixelRatio();
+            painter.drawPixmap(dirty, chrome, QRect(dirty.topLeft() * dpr, dirty.size() * dpr));
         }
-        else // correct_prog // 显示箭头
+        else
         {
-            QFont ft = line_edit->font();
-            QFontMetrics fm(ft);
-            const int short_len = fm.height(); // 线的长度
-            const int blank_len = fm.horizontalAdvance(" ") / 2; // 空白点的宽度
-            const int move_left = short_len / 2;
-            const int step1 = 40;
-            const int step2 = 75;
-            const int step3 = 85;
-            const int step4 = 100;
-
-            // 绘制两截的线
-            auto paint2Line = [&](int blank_left, int right_margin) {
-                // 绘制普通下划线
-                painter.setPen(QPen(grayed_color, 1, Qt::SolidLine, Qt::RoundCap));
-                painter.drawLine(line_left, line_top, blank_left, line_top);
-                if (blank_left+blank_len < line_right)
-                    painter.drawLine(blank_left + blank_len, line_top, line_right - right_margin, line_top);
-
-                // 绘制高亮下划线
-                if (focus_prog || loses_prog)
-                {
-                    painter.setPen(QPen(accent_color, pen_width));
-                    int w = line_width * focus_prog / 100;
-                    int l = line_left + line_width * loses_prog / 100;
-                    int r = line_left + w;
-                    if (r <= blank_left)
-                    {
-                        painter.drawLine(l, line_top, r, line_top);
-                    }
-                    else // 分为两截画
-                    {
-                        painter.drawLine(l, line_top, blank_left, line_top);
-                        if (blank_left + blank_len < line_right)
-                            painter.drawLine(blank_left + blank_len, line_top, qMin(r, line_right - right_margin), line_top);
-                    }
-                }
-            };
-
-            if (correct_prog <= step1) // 分割
-            {
-                int move_dis = move_left * correct_prog / step1; // 左移的位置
-                int blank_left = line_right - blank_len - short_len - move_dis; // 隔断点的左边
-                paint2Line(blank_left, move_dis);
-            }
-            else // 延伸、旋转
-            {
-                if (correct_prog <= step2)
-                {
-                    // 画两截的线
-                    int move_dis = (short_len + move_left + blank_len) * (correct_prog - step1) / (step2 - step1); // 相对于上一阶段的最左边
-                    int blank_left = line_right - (short_len + move_left + blank_len) + move_dis;
-                    paint2Line(blank_left, move_left);
-                }
-                else
-                {
-                    // 画普通的线
-                    paintLine();
-                }
-
-                painter.setPen(QPen(accent_color, pen_width));
-                painter.setRenderHint(QPainter::Antialiasing, true);
-                double radius = short_len / 2.0;
-                const int offset = 2; // 线宽的偏移
-                double angle_turned = 0;
-                if (correct_prog >= step1 && correct_prog <= step2) // 画弧线
-                {
-                    // 出现的弧线
-                    QRect rect(line_right - short_len, line_top-short_len, short_len, short_len);
-                    painter.setPen(QPen(accent_color, pen_width));
-                    double angle_span = 360/PI;
-                    double angle = -90 + (150+angle_span) * (correct_prog - step1) / (step2 - step1);
-                    if (angle - angle_span < -90) // 一开始的
-                        angle_span = angle+90;
-                    if (angle > 60) // 准备转弯
-                    {
-                        angle_turned = angle - 60;
-                        angle_span -= (angle - 60);
-                        angle = 60;
-                    }
-                    painter.drawArc(rect, static_cast<int>(angle * 16), static_cast<int>(-angle_span * 16));
-                }
-
-                if (correct_prog >= step2)
-                    angle_turned = 360/PI;
-                if (angle_turned > 0)
-                {
-                    QPointF pos2(line_right - radius/2, line_top - radius - radius/2 * sin(PI/3)-3);   // 右上角
-                    QPointF pos1(line_right - radius*3/2 + offset, line_top - radius + radius/2 * sin(PI/3)); // 左下角
-                    double turned_len = PI * short_len * angle_turned / 360;
-                    double cent = turned_len / short_len;
-                    if (cent > 1)
-                        cent = 1;
-                    double x = pos2.x() + (pos1.x() - pos2.x()) * cent;
-                    double y = pos2.y() + (pos1.y() - pos2.y()) * cent;
-                    QPointF pos(x, y);
-                    painter.drawLine(pos2, pos);
-                }
-
-                if (correct_prog >= step3) // 画勾的左半部分
-                {
-                    QPointF pos2(line_right - radius*3/2 + offset, line_top - radius + radius/2 * sin(PI/3)); // 右下角
-                    QPointF pos1(line_right - short_len + offset, line_top - radius);
-                    double cent = (correct_prog - step3) / static_cast<double>(step4 - step3);
-                    if (cent > 1)
-                        cent = 1;
-                    double x = pos2.x() + (pos1.x() - pos2.x()) * cent;
-                    double y = pos2.y() + (pos1.y() - pos2.y()) * cent;
-                    QPointF pos(x, y);
-                    painter.drawLine(pos2, pos);
-                }
-            }
-        }
-
-        // 绘制文字
-        if (!label_text.isEmpty())
-        {
-            QFont nft = line_edit->font();
-            painter.setPen(QPen(grayed_color, 1));
-//            painter.setRenderHint(QPainter::TextAntialiasing, true);
-
-            if (label_prog <= 0) // 在输入框里面
-            {
-                painter.setFont(nft);
-                for (int i = 0; i < label_text.size(); i++)
-                {
-                    painter.drawText(label_in_poss.at(i), label_text.at(i));
-                }
-            }
-            else if (label_prog >= 100) // 在输入框上面
-            {
-                QFont sft = nft;
-                sft.setPointSizeF(nft.pointSize() / label_scale);
-                painter.setFont(sft);
-
-                for (int i = 0; i < label_text.size(); i++)
-                {
-                    painter.drawText(label_up_poss.at(i), label_text.at(i));
-                }
-
-            }
-            else if (focus_prog && !loses_prog)
-            {
-                QFont aft = line_edit->font();
-                const double in_size = nft.pointSizeF();
-                const double up_size = in_size / label_scale;
-                const int count = label_text.size();
-                if (label_text.size() > label_ani_max) // 左边先抬起来，左边进度最大
-                {
-                    const double step = 100.0 / count / 2.5; // 每个文字动画比前面文字慢一点，有种曲线感
-                    const double persist_prog = 100 - step * (count-1); // 每个字符动画的真正时长
-                    for (int i = 0; i < count; i++)
-                    {
-                        double char_min_prog = step * i;
-                        double prog = label_prog - char_min_prog; // 相对于这个字符串的本身周期的prog
-                        if (prog < 0)
-                            prog = 0;
-                        else if (prog > persist_prog)
-                            prog = persist_prog;
-                        const double max_angle = PI * (0.5 + 1.0/6 * (count-i/2) / count); // 2/3π~4/3π角度为超过上限
-                        const double out_prob = 1.0 / sin(max_angle) - 1;
-                        const double angle = max_angle * prog / persist_prog;
-                        const double cent = sin(angle) * (1 + out_prob); // sin(a)是100的百分比，这里超出20%左右
-                        const double size = in_size - (in_size - up_size) * cent;
-                        aft.setPointSizeF(size);
-                        QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
-                        const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * cent;
-                        const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * cent;
-                        QPointF pos(x, y);
-                        painter.setFont(aft);
-                        painter.drawText(pos, label_text.at(i));
-                        prog -= step;
-                    }
-                }
-                else // 全部一致的文字运动
-                {
-                    double prop = label_prog / 100;
-                    const double size = in_size - (in_size - up_size) * prop;
-                    aft.setPointSizeF(size);
-                    painter.setFont(aft);
-                    for (int i = 0; i < count; i++)
-                    {
-                        QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
-                        const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * prop;
-                        const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * prop;
-                        QPointF pos(x, y);
-                        painter.drawText(pos, label_text.at(i));
-                    }
-                }
-
-            }
-            else // loses_prog
-            {
-                // 左边先下来
-                QFont aft = line_edit->font();
-                const double in_size = nft.pointSizeF();
-                const double up_size = in_size / label_scale;
-                const int count = label_text.size();
-                if (label_text.size() > label_ani_max)
-                {
-                    const double step = 100.0 / count / 4; // 每个文字动画比前面文字慢一点，有种曲线感
-                    const double max_angle = PI / 2; // 2/3π~4/3π角度为超过上限
-                    const double persist_prog = 100 - step * (count-1); // 每个字符动画的真正时长
-                    for (int i = 0; i < count; i++)
-                    {
-                        double char_min_prog = step * (count - i - 1);
-                        double prog = label_prog - char_min_prog; // 相对于这个字符串的本身周期的prog
-                        if (prog < 0)
-                            prog = 0;
-                        else if (prog > persist_prog)
-                            prog = persist_prog;
-                        double angle = max_angle * prog / persist_prog;
-                        double cent = sin(angle); // sin(a)是100的百分比
-                        double size = in_size - (in_size - up_size) * cent;
-                        aft.setPointSizeF(size);
-                        QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
-                        double x = in_pos.x() - (in_pos.x() - up_pos.x()) * cent;
-                        double y = in_pos.y() - (in_pos.y() - up_pos.y()) * cent;
-                        QPointF pos(x, y);
-                        painter.setFont(aft);
-                        painter.drawText(pos, label_text.at(i));
-                        prog -= step;
-                    }
-                }
-                else
-                {
-                    double prop = label_prog / 100;
-                    const double size = in_size - (in_size - up_size) * prop;
-                    aft.setPointSizeF(size);
-                    painter.setFont(aft);
-                    for (int i = 0; i < count; i++)
-                    {
-                        QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
-                        const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * prop;
-                        const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * prop;
-                        QPointF pos(x, y);
-                        painter.drawText(pos, label_text.at(i));
-                    }
-                }
-            }
+            paintChrome(painter, dirty);
         }
     }
     else // 错误曲线
     {
         QFont nft = line_edit->font();
         QFontMetricsF nfm(nft);
-        double n_offset = nfm.horizontalAdvance(line_edit->displayText()) / 2;
+        const QString display_text = line_edit->displayText();
+        if (wave_text != display_text || wave_font != nft || wave_advances.isEmpty())
+        {
+            // 内容不变时不重新测量；整行排版一次，和输入框一样带字距调整
+            wave_text = display_text;
+            wave_font = nft;
+            QTextLayout layout(display_text, nft);
+            layout.beginLayout();
+            QTextLine line = layout.createLine();
+            if (line.isValid())
+                line.setNumColumns(display_text.length());
+            layout.endLayout();
+            lineAdvances(line, display_text.length(), &wave_advances);
+        }
+        double n_offset = qMin(wave_advances.last(), static_cast<qreal>(line_width)) / 2; // 只算看得见的部分
         QFont sft = nft;
         QFontMetricsF sfm(sft);
         double s_offset = sfm.horizontalAdvance(label_text) * 2 / 3;
@@ -620,60 +853,104 @@ void LabeledEdit::paintEvent(QPaintEvent *)
         painter.drawPath(path);
         painter.restore();
 
-        // 绘制文字
-        painter.setPen(QPen(grayed_color, 1));
-        if (line_edit->text().isEmpty() && !line_edit->hasFocus()) // 标签在编辑框中
+        if (wrong_wave_mode == SnapshotWave && !wave_snapshot.isNull())
         {
-            painter.setFont(nft);
-            for (int i = 0; i < label_text.size(); i++)
+            // 把开始时的截图按列平移，耗时只和控件宽度有关
+            const qreal dpr = wave_snapshot.devicePixelRatio();
+            const int strip = 2; // 每一列的宽度
+            auto paintBand = [&](int top, int bottom, double offset, double scale) {
+                for (int x = 0; x < width(); x += strip)
+                {
+                    double perc = qBound(0.0, (x - offset - paint_left) / total_len, 1.0);
+                    double dy = (path.pointAtPercent(perc).y() - line_top) / scale;
+                    painter.drawImage(QRectF(x, top + dy, strip, bottom - top), wave_snapshot,
+                                      QRectF(x * dpr, top * dpr, strip * dpr, (bottom - top) * dpr));
+                }
+            };
+            if (wave_label_inside) // 只有编辑框中的标签
+            {
+                paintBand(0, height(), 0, 1);
+            }
+            else // 上方的标签 + 输入的内容
             {
-                double x = label_in_poss.at(i).x();
-                double perc = (x - paint_left) / total_len;
-                double y = path.pointAtPercent(perc).y();
-                painter.drawText(QPointF(x, y + label_in_poss.at(i).y() - line_top), label_text.at(i));
+                paintBand(0, geom.top(), s_offset, label_scale);
+                paintBand(geom.top(), height(), n_offset, 1);
             }
         }
-        else // 标签在编辑框上面
+        else
         {
-            sft.setPointSizeF(nft.pointSize() / label_scale);
-            painter.setFont(sft);
-
-            for (int i = 0; i < label_text.size(); i++)
+            // 绘制文字
+            painter.setPen(QPen(grayed_color, 1));
+            if (line_edit->text().isEmpty() && !line_edit->hasFocus()) // 标签在编辑框中
             {
-                double x = label_up_poss.at(i).x();
-                double perc = (x - paint_left - s_offset) / total_len;
-                if (perc < 0)
-                    perc = 0;
-                double y = path.pointAtPercent(perc).y();
-                painter.drawText(QPointF(x, label_up_poss.at(i).y() + (y-line_top)/label_scale), label_text.at(i));
+                for (int i = 0; i < label_in_char_runs.size(); i++)
+                {
+                    double x = label_in_poss.at(i).x();
+                    double perc = (x - paint_left) / total_len;
+                    double y = path.pointAtPercent(perc).y();
+                    drawGlyphRuns(painter, QPointF(x, y + label_in_poss.at(i).y() - line_top), label_in_char_runs.at(i));
+                }
             }
-
-            // 输入文字的曲线动画
-            QString display_text = line_edit->displayText();
-            if (!display_text.isEmpty())
+            else // 标签在编辑框上面
             {
-                painter.setFont(nft);
-                painter.setPen(line_edit->palette().color(QPalette::Text));
-                QPointF pos = line_edit->geometry().bottomLeft(); // 绘制左下角（值不要是浮点数，不然动起来会抖）
-                pos = QPointF(pos.x() + 1 + 2, // padding=1，多的2就不知道了……
-                              pos.y() + nfm.height() - nfm.lineSpacing()
-                              - (line_edit->size().height() - line_edit->sizeHint().height() + 1)/2);
-                for (int i = 0; i < display_text.size(); i++)
+                for (int i = 0; i < label_up_char_runs.size(); i++)
                 {
-                    double x = pos.x() + nfm.horizontalAdvance(display_text.left(i));
-                    double perc = (x - n_offset - paint_left) / total_len;
+                    double x = label_up_poss.at(i).x();
+                    double perc = (x - paint_left - s_offset) / total_len;
                     if (perc < 0)
                         perc = 0;
                     double y = path.pointAtPercent(perc).y();
-                    painter.drawText(QPointF(x, y + pos.y() - line_top), display_text.at(i));
+                    drawGlyphRuns(painter, QPointF(x, label_up_poss.at(i).y() + (y-line_top)/label_scale), label_up_char_runs.at(i));
                 }
-            }
 
+                // 输入文字的曲线动画
+                if (!display_text.isEmpty())
+                {
+                    painter.setFont(nft);
+                    painter.setPen(line_edit->palette().color(QPalette::Text));
+                    QPointF pos = line_edit->geometry().bottomLeft(); // 绘制左下角（值不要是浮点数，不然动起来会抖）
+                    pos = QPointF(pos.x() + 1 + 2, // padding=1，多的2就不知道了……
+                                  pos.y() + nfm.height() - nfm.lineSpacing()
+                                  - (line_edit->size().height() - line_edit->sizeHint().height() + 1)/2);
+
+                    // 内容超出输入框时，按光标位置推算横向滚动的距离，和输入框显示的一致
+                    double scroll = 0;
+                    if (wave_advances.last() > line_width - (pos.x() - line_left) * 2)
+                    {
+                        const int cursor = qBound(0, line_edit->cursorPosition(), display_text.size());
+                        const double cursor_x = line_left + line_edit->cursorGeometry().center().x();
+                        scroll = qMax(0, qRound(pos.x() + wave_advances.at(cursor) - cursor_x)); // 取整，避免和输入框的文字错开半个像素
+                    }
+
+                    // 只绘制输入框中看得见的字符
+                    const auto first_it = std::upper_bound(wave_advances.begin(), wave_advances.end(), scroll - (pos.x() - line_left));
+                    const int first = qMax(0, static_cast<int>(first_it - wave_advances.begin()) - 1);
+                    const double visible_right = scroll + line_right - pos.x();
+                    painter.save();
+                    painter.setClipRect(QRectF(line_left, 0, line_width, height()), Qt::IntersectClip);
+                    for (int i = first; i < display_text.size() && wave_advances.at(i) <= visible_right; i++)
+                    {
+                        double x = pos.x() + wave_advances.at(i) - scroll;
+                        double perc = (x - n_offset - paint_left) / total_len;
+                        if (perc < 0)
+                            perc = 0;
+                        double y = path.pointAtPercent(perc).y();
+                        int size = 1;
+                        if (display_text.at(i).isHighSurrogate() && i + 1 < display_text.size())
+                            size = 2; // 不能拆开的字符
+                        painter.drawText(QPointF(x, y + pos.y() - line_top), display_text.mid(i, size));
+                        i += size - 1;
+                    }
+                    painter.restore();
+                }
+
+            }
         }
     }
 
     // 绘制逐渐消失的msg
-    if (msg_hide_prog && msg_hide_prog < 100 && !msg_hiding.isEmpty())
+    const bool msg_dirty = dirty.intersects(messageRect());
+    if (msg_dirty && msg_hide_prog && msg_hide_prog < 100 && !msg_hiding.isEmpty())
     {
         QFont sft = line_edit->font();
         double size = sft.pointSize() / label_scale - pen_width/2;
@@ -753,7 +1030,7 @@ void LabeledEdit::paintEvent(QPaintEvent *)
     }
 
     // 逐渐显示的msg
-    if (msg_show_prog && !msg_text.isEmpty())
+    if (msg_dirty && msg_show_prog && !msg_text.isEmpty())
     {
         QFont sft = line_edit->font();
         sft.setPointSizeF(sft.pointSize() / label_scale - pen_width/2);
@@ -791,7 +1068,7 @@ void LabeledEdit::paintEvent(QPaintEvent *)
     }
 
     // 绘制提示文字
-    else if (tip_prog && !tip_text.isEmpty())
+    else if (msg_dirty && tip_prog && !tip_text.isEmpty())
     {
         QFont sft = line_edit->font();
         sft.setPointSizeF(sft.pointSize() / label_scale - pen_width/2);
@@ -806,7 +1083,7 @@ void LabeledEdit::paintEvent(QPaintEvent *)
     }
 
     // 绘制加载中动画
-    if (show_loading_prog || hide_loading_prog)
+    if ((show_loading_prog || hide_loading_prog) && dirty.intersects(loadingRect()))
     {
         painter.setRenderHint(QPainter::Antialiasing, true);
         // 半径与 show_loading_prog 有关，线条长度与 hide_loading_prog 有关
@@ -839,6 +1116,380 @@ void LabeledEdit::paintEvent(QPaintEvent *)
     }
 }
 
+/**
+ * 绘制下划线、勾、标签
+ * @param dirty 需要更新的区域，标签不在其中时不绘制
+ */
+void LabeledEdit::paintChrome(QPainter &painter, const QRect &dirty)
+{
+    const double PI = 3.141592;
+    QRect geom = line_edit->geometry();
+
+    const int line_left = geom.left(), line_right = geom.right();
+    const int line_top = geom.bottom(), line_width = geom.width();
+
+    auto paintLine = [&]{
+        // 绘制普通下划线
+        painter.setPen(QPen(grayed_color, 1, Qt::SolidLine, Qt::RoundCap));
+        painter.drawLine(line_left, line_top, line_right, line_top);
+
+        // 绘制高亮下划线
+        if (focus_prog || loses_prog)
+        {
+            int w = line_width * focus_prog / 100;
+            int l = line_left + line_width * loses_prog / 100;
+            painter.setPen(QPen(accent_color, pen_width));
+            painter.drawLine(l, line_top, line_left + w, line_top);
+        }
+    };
+
+    // 绘制勾
+    if (!correct_prog) // 普通下划线
+    {
+        paintLine();
+    }
+    else // correct_prog // 显示箭头
+    {
+        QFont ft = line_edit->font();
+        QFontMetrics fm(ft);
+        const int short_len = fm.height(); // 线的长度
+        const int blank_len = fm.horizontalAdvance(" ") / 2; // 空白点的宽度
+        const int move_left = short_len / 2;
+        const int step1 = 40;
+        const int step2 = 75;
+        const int step3 = 85;
+        const int step4 = 100;
+
+        // 绘制两截的线
+        auto paint2Line = [&](int blank_left, int right_margin) {
+            // 绘制普通下划线
+            painter.setPen(QPen(grayed_color, 1, Qt::SolidLine, Qt::RoundCap));
+            painter.drawLine(line_left, line_top, blank_left, line_top);
+            if (blank_left+blank_len < line_right)
+                painter.drawLine(blank_left + blank_len, line_top, line_right - right_margin, line_top);
+
+            // 绘制高亮下划线
+            if (focus_prog || loses_prog)
+            {
+                painter.setPen(QPen(accent_color, pen_width));
+                int w = line_width * focus_prog / 100;
+                int l = line_left + line_width * loses_prog / 100;
+                int r = line_left + w;
+                if (r <= blank_left)
+                {
+                    painter.drawLine(l, line_top, r, line_top);
+                }
+                else // 分为两截画
+                {
+                    painter.drawLine(l, line_top, blank_left, line_top);
+                    if (blank_left + blank_len < line_right)
+                        painter.drawLine(blank_left + blank_len, line_top, qMin(r, line_right - right_margin), line_top);
+                }
+            }
+        };
+
+        if (correct_prog <= step1) // 分割
+        {
+            int move_dis = move_left * correct_prog / step1; // 左移的位置
+            int blank_left = line_right - blank_len - short_len - move_dis; // 隔断点的左边
+            paint2Line(blank_left, move_dis);
+        }
+        else // 延伸、旋转
+        {
+            if (correct_prog <= step2)
+            {
+                // 画两截的线
+                int move_dis = (short_len + move_left + blank_len) * (correct_prog - step1) / (step2 - step1); // 相对于上一阶段的最左边
+                int blank_left = line_right - (short_len + move_left + blank_len) + move_dis;
+                paint2Line(blank_left, move_left);
+            }
+            else
+            {
+                // 画普通的线
+                paintLine();
+            }
+
+            painter.setPen(QPen(accent_color, pen_width));
+            painter.setRenderHint(QPainter::Antialiasing, true);
+            double radius = short_len / 2.0;
+            const int offset = 2; // 线宽的偏移
+            double angle_turned = 0;
+            if (correct_prog >= step1 && correct_prog <= step2) // 画弧线
+            {
+                // 出现的弧线
+                QRect rect(line_right - short_len, line_top-short_len, short_len, short_len);
+                painter.setPen(QPen(accent_color, pen_width));
+                double angle_span = 360/PI;
+                double angle = -90 + (150+angle_span) * (correct_prog - step1) / (step2 - step1);
+                if (angle - angle_span < -90) // 一开始的
+                    angle_span = angle+90;
+                if (angle > 60) // 准备转弯
+                {
+                    angle_turned = angle - 60;
+                    angle_span -= (angle - 60);
+                    angle = 60;
+                }
+                painter.drawArc(rect, static_cast<int>(angle * 16), static_cast<int>(-angle_span * 16));
+            }
+
+            if (correct_prog >= step2)
+                angle_turned = 360/PI;
+            if (angle_turned > 0)
+            {
+                QPointF pos2(line_right - radius/2, line_top - radius - radius/2 * sin(PI/3)-3);   // 右上角
+                QPointF pos1(line_right - radius*3/2 + offset, line_top - radius + radius/2 * sin(PI/3)); // 左下角
+                double turned_len = PI * short_len * angle_turned / 360;
+                double cent = turned_len / short_len;
+                if (cent > 1)
+                    cent = 1;
+                double x = pos2.x() + (pos1.x() - pos2.x()) * cent;
+                double y = pos2.y() + (pos1.y() - pos2.y()) * cent;
+                QPointF pos(x, y);
+                painter.drawLine(pos2, pos);
+            }
+
+            if (correct_prog >= step3) // 画勾的左半部分
+            {
+                QPointF pos2(line_right - radius*3/2 + offset, line_top - radius + radius/2 * sin(PI/3)); // 右下角
+                QPointF pos1(line_right - short_len + offset, line_top - radius);
+                double cent = (correct_prog - step3) / static_cast<double>(step4 - step3);
+                if (cent > 1)
+                    cent = 1;
+                double x = pos2.x() + (pos1.x() - pos2.x()) * cent;
+                double y = pos2.y() + (pos1.y() - pos2.y()) * cent;
+                QPointF pos(x, y);
+                painter.drawLine(pos2, pos);
+            }
+        }
+    }
+
+    // 绘制文字
+    if (!label_text.isEmpty() && dirty.intersects(labelRect()))
+    {
+        QFont nft = line_edit->font();
+        painter.setPen(QPen(grayed_color, 1));
+        const double in_size = nft.pointSizeF();
+        const double up_size = in_size / label_scale;
+
+        // 动画中的一个字形簇：把靠近的一端排版好的字形缩放到当前字号，不重新排版；
+        // 缩放模式下把输入框字号的图片缩小，不会产生新的字形缓存
+        auto drawLabelChar = [&](int i, const QPointF& pos, double size) {
+            painter.save();
+            painter.translate(pos);
+            if (label_scaled && i < label_char_images.size())
+            {
+                const double scale = size / in_size;
+                painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+                painter.scale(scale, scale);
+                painter.drawImage(-label_image_origin, label_char_images.at(i));
+            }
+            else
+            {
+                const bool near_in = size * 2 >= in_size + up_size;
+                const double scale = size / (near_in ? in_size : up_size);
+                painter.scale(scale, scale);
+                drawGlyphRuns(painter, QPointF(0, 0), near_in ? label_in_char_runs.at(i) : label_up_char_runs.at(i));
+            }
+            painter.restore();
+        };
+        if (label_scaled && label_prog > 0 && label_prog < 100)
+            updateLabelCharImages();
+//            painter.setRenderHint(QPainter::TextAntialiasing, true);
+
+        if (label_prog <= 0) // 在输入框里面
+        {
+            drawGlyphRuns(painter, label_in_poss.first(), label_in_runs);
+        }
+        else if (label_prog >= 100) // 在输入框上面
+        {
+            drawGlyphRuns(painter, label_up_poss.first(), label_up_runs);
+        }
+        else if (focus_prog && !loses_prog)
+        {
+            const int count = label_in_char_runs.size();
+            if (count > label_ani_max) // 左边先抬起来，左边进度最大
+            {
+                const double step = 100.0 / count / 2.5; // 每个文字动画比前面文字慢一点，有种曲线感
+                const double persist_prog = 100 - step * (count-1); // 每个字符动画的真正时长
+                for (int i = 0; i < count; i++)
+                {
+                    double char_min_prog = step * i;
+                    double prog = label_prog - char_min_prog; // 相对于这个字符串的本身周期的prog
+                    if (prog < 0)
+                        prog = 0;
+                    else if (prog > persist_prog)
+                        prog = persist_prog;
+                    const double max_angle = PI * (0.5 + 1.0/6 * (count-i/2) / count); // 2/3π~4/3π角度为超过上限
+                    const double out_prob = 1.0 / sin(max_angle) - 1;
+                    const double angle = max_angle * prog / persist_prog;
+                    const double cent = sin(angle) * (1 + out_prob); // sin(a)是100的百分比，这里超出20%左右
+                    const double size = in_size - (in_size - up_size) * cent;
+                    QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
+                    const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * cent;
+                    const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * cent;
+                    QPointF pos(x, y);
+                    drawLabelChar(i, pos, size);
+                    prog -= step;
+                }
+            }
+            else // 全部一致的文字运动
+            {
+                double prop = label_prog / 100;
+                const double size = in_size - (in_size - up_size) * prop;
+                for (int i = 0; i < count; i++)
+                {
+                    QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
+                    const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * prop;
+                    const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * prop;
+                    QPointF pos(x, y);
+                    drawLabelChar(i, pos, size);
+                }
+            }
+
+        }
+        else // loses_prog
+        {
+            // 左边先下来
+            const int count = label_in_char_runs.size();
+            if (count > label_ani_max)
+            {
+                const double step = 100.0 / count / 4; // 每个文字动画比前面文字慢一点，有种曲线感
+                const double max_angle = PI / 2; // 2/3π~4/3π角度为超过上限
+                const double persist_prog = 100 - step * (count-1); // 每个字符动画的真正时长
+                for (int i = 0; i < count; i++)
+                {
+                    double char_min_prog = step * (count - i - 1);
+                    double prog = label_prog - char_min_prog; // 相对于这个字符串的本身周期的prog
+                    if (prog < 0)
+                        prog = 0;
+                    else if (prog > persist_prog)
+                        prog = persist_prog;
+                    double angle = max_angle * prog / persist_prog;
+                    double cent = sin(angle); // sin(a)是100的百分比
+                    double size = in_size - (in_size - up_size) * cent;
+                    QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
+                    double x = in_pos.x() - (in_pos.x() - up_pos.x()) * cent;
+                    double y = in_pos.y() - (in_pos.y() - up_pos.y()) * cent;
+                    QPointF pos(x, y);
+                    drawLabelChar(i, pos, size);
+                    prog -= step;
+                }
+            }
+            else
+            {
+                double prop = label_prog / 100;
+                const double size = in_size - (in_size - up_size) * prop;
+                for (int i = 0; i < count; i++)
+                {
+                    QPointF in_pos(label_in_poss.at(i)), up_pos(label_up_poss.at(i));
+                    const double y = in_pos.y() - (in_pos.y() - up_pos.y()) * prop;
+                    const double x = in_pos.x() - (in_pos.x() - up_pos.x()) * prop;
+                    QPointF pos(x, y);
+                    drawLabelChar(i, pos, size);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 标签动画使用缩放而不是逐帧改变字号
+ * 每个不同的小数字号都会创建新的字体引擎与字形缓存，长时间运行时内存会一直增加；
+ * 开启后只在输入框字号绘制一次每个字符，动画中缩小图片
+ */
+void LabeledEdit::setScaledLabelAnimation(bool enable)
+{
+    label_scaled = enable;
+    if (!enable)
+        label_char_images.clear();
+}
+
+/**
+ * 按输入框字号绘制标签的每个字符，标签、字体、颜色改变时重新绘制
+ */
+void LabeledEdit::updateLabelCharImages()
+{
+    const QFont nft = line_edit->font();
+    const qreal dpr = devicePixelRatioF();
+    if (label_images_text == label_text && label_images_font == nft && label_images_color == grayed_color.rgba()
+            && label_images_dpr == dpr && label_char_images.size() == label_in_char_runs.size())
+        return ;
+    label_images_text = label_text;
+    label_images_font = nft;
+    label_images_color = grayed_color.rgba();
+    label_images_dpr = dpr;
+
+    QFontMetricsF nfm(nft);
+    const int margin = 2; // 字形可能超出步进宽度
+    label_image_origin = QPointF(margin, nfm.ascent());
+    label_char_images.clear();
+    for (int i = 0; i < label_in_char_runs.size(); i++)
+    {
+        const int from = label_clusters.at(i);
+        QSizeF size(nfm.horizontalAdvance(label_text.mid(from, label_clusters.at(i + 1) - from)) + margin * 2, nfm.height());
+        QImage image((size * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setPen(QPen(grayed_color, 1));
+        drawGlyphRuns(painter, label_image_origin, label_in_char_runs.at(i));
+        painter.end();
+        label_char_images.append(image);
+    }
+}
+
+/**
+ * 是否处于静止状态：标签完全在里面或上面，下划线、勾没有动画
+ * 提示、错误信息、加载动画在上面单独绘制，不影响
+ */
+bool LabeledEdit::isChromeResting() const
+{
+    return (label_prog <= 0 || label_prog >= 100)
+            && (focus_prog == 0 || focus_prog == 100) && loses_prog == 0
+            && (correct_prog == 0 || correct_prog == 100);
+}
+
+/**
+ * 静止状态的下划线、勾、标签，按设备像素比绘制
+ * 文字、字体、尺寸、颜色、状态改变时重新绘制；整个窗口重绘（例如关闭对话框后）时每个输入框只需要贴一次图
+ */
+const QPixmap &LabeledEdit::getChromePixmap()
+{
+    ChromeKey key;
+    key.size = size();
+    key.dpr = devicePixelRatioF();
+    key.geom = line_edit->geometry();
+    key.label = label_text;
+    key.font = line_edit->font();
+    key.label_pos = label_in_poss.isEmpty() ? QPointF() : label_in_poss.first();
+    key.grayed = grayed_color.rgba();
+    key.accent = accent_color.rgba();
+    key.label_up = label_prog >= 100;
+    key.focus_prog = focus_prog;
+    key.correct_prog = correct_prog;
+    if (chrome_pixmap.isNull() || !(key == chrome_key))
+    {
+        chrome_pixmap = QPixmap(key.size * key.dpr);
+        chrome_pixmap.setDevicePixelRatio(key.dpr);
+        chrome_pixmap.fill(Qt::transparent);
+        chrome_key = key;
+        QPainter painter(&chrome_pixmap);
+        paintChrome(painter, rect());
+    }
+    return chrome_pixmap;
+}
+
+/**
+ * 是否缓存静止状态的下划线与标签，默认开启
+ * 关闭后释放缓存，每次都重新绘制
+ */
+void LabeledEdit::setChromeCache(bool enable)
+{
+    chrome_cache = enable;
+    if (!enable)
+        chrome_pixmap = QPixmap();
+}
+
 void LabeledEdit::enterEvent(QEvent *event)
 {
     QWidget::enterEvent(event);
@@ -859,22 +1510,324 @@ void LabeledEdit::leaveEvent(QEvent *event)
     }
 }
 
-QPropertyAnimation* LabeledEdit::startAnimation(QByteArray name, double start, double end, int duration, QEasingCurve curve)
+void LabeledEdit::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    resumeAnimations();
+}
+
+void LabeledEdit::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    suspendAnimations();
+}
+
+/**
+ * 监听所在窗口重新显示（从最小化、遮挡中恢复）
+ */
+bool LabeledEdit::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Expose && FrameScheduler::isExposed(this))
+    {
+        watched->removeEventFilter(this);
+        resumeAnimations();
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+/**
+ * 各个动画元素所在的区域
+ * 属性变化时只刷新对应的区域，而不是整个控件
+ */
+QRect LabeledEdit::underlineRect() const
+{
+    QRect geom = line_edit->geometry();
+    return QRect(geom.left() - pen_width, geom.bottom() - pen_width * 2, geom.width() + pen_width * 2, pen_width * 4);
+}
+
+/**
+ * 标签从输入框里面移动到上方，覆盖输入框及其上面的空白
+ */
+QRect LabeledEdit::labelRect() const
+{
+    return QRect(0, 0, width(), line_edit->geometry().bottom() + 1);
+}
+
+/**
+ * 下划线下方的提示/错误信息
+ */
+QRect LabeledEdit::messageRect() const
+{
+    int top = line_edit->geometry().bottom();
+    return QRect(0, top, width(), height() - top);
+}
+
+/**
+ * 右边的勾，以及被勾截断的下划线
+ */
+QRect LabeledEdit::correctRect() const
+{
+    QRect geom = line_edit->geometry();
+    QRectF box(geom.right() - label_nh * 2, geom.bottom() - label_nh - pen_width * 2 - 3,
+               label_nh * 2 + pen_width * 2, label_nh + pen_width * 4 + 3);
+    return box.toAlignedRect().united(underlineRect());
+}
+
+QRect LabeledEdit::loadingRect() const
+{
+    return loading_rect.adjusted(-pen_width * 2, -pen_width * 2, pen_width * 2, pen_width * 2);
+}
+
+/**
+ * 动画使用的当前时间
+ * 暂停中停在暂停的那一刻，恢复后所有动画整体往后平移
+ */
+qint64 LabeledEdit::aniNow() const
+{
+    return ani_suspended ? suspend_time : AnimationClock::now();
+}
+
+/**
+ * 看不见时暂停所有动画与加载菊花，不再占用帧时钟
+ */
+void LabeledEdit::suspendAnimations()
 {
-    QPropertyAnimation* ani = new QPropertyAnimation(this, name);
-    ani->setStartValue(start);
-    ani->setEndValue(end);
-    ani->setDuration(static_cast<int>(duration * qAbs(start - end) / 100));
-    ani->setEasingCurve(curve);
-    ani->start();
-    connect(ani, SIGNAL(finished()), ani, SLOT(deleteLater()));
-    return ani;
+    if (ani_suspended)
+        return ;
+    if (edit_pending) // 合并中的编辑立即切换，不等到重新可见
+        editTransition();
+    ani_suspended = true;
+    suspend_time = AnimationClock::now();
+    FrameScheduler::instance()->unsubscribe(this);
+}
+
+/**
+ * 重新可见时从暂停的位置继续
+ */
+void LabeledEdit::resumeAnimations()
+{
+    if (!ani_suspended)
+        return ;
+    ani_suspended = false;
+    const qint64 delta = AnimationClock::now() - suspend_time;
+    bool running = loading_running;
+    for (int i = 0; i < AniChannelCount; i++)
+    {
+        if (!ani_slots[i].running)
+            continue;
+        ani_slots[i].start_time += delta;
+        running = true;
+    }
+    loading_start_time += delta;
+    if (running)
+        FrameScheduler::instance()->subscribe(this);
+}
+
+/**
+ * 开始某个进度的动画
+ * 每个进度只有一个预先分配的动画槽，动画中再次调用会直接修改目标值（不会多个动画同时修改同一个进度）
+ * @param channel  进度通道
+ * @param start    起始值（一般为当前值）
+ * @param end      目标值
+ * @param duration 从0到100的完整时长，实际时长按距离比例计算
+ * @param curve    动画曲线
+ */
+void LabeledEdit::startAnimation(AniChannel channel, double start, double end, int duration, QEasingCurve::Type curve)
+{
+    AniSlot& slot = ani_slots[channel];
+    PERF_ANIMATION(perf_counters, slot.running);
+    if (slot.running) // 被新目标打断
+    {
+        TRACE_ASYNC_END("LabeledEdit", channel_names[channel], reinterpret_cast<quintptr>(this) + channel);
+    }
+    TRACE_ASYNC_BEGIN("LabeledEdit", channel_names[channel], reinterpret_cast<quintptr>(this) + channel); // 每个通道单独的标识，同时进行的动画才不会配错
+    slot.start = start;
+    slot.end = end;
+    slot.duration = static_cast<int>(duration * qAbs(start - end) / 100);
+    slot.start_time = aniNow();
+    if (slot.curve.type() != curve)
+        slot.curve.setType(curve);
+
+    setChannelProg(channel, start);
+    if (slot.duration <= 0) // 已经在终点了
+    {
+        slot.running = false;
+        TRACE_ASYNC_END("LabeledEdit", channel_names[channel], reinterpret_cast<quintptr>(this) + channel);
+        setChannelProg(channel, end);
+        finishAnimation(channel);
+        return ;
+    }
+    slot.running = true;
+    if (!ani_suspended) // 暂停中开始的动画等到重新可见时再开始
+        FrameScheduler::instance()->subscribe(this);
+}
+
+/**
+ * 全局帧时钟的回调
+ * 所有正在进行的动画前进一帧，加载中的菊花按时间转动
+ * 全部结束后取消订阅
+ */
+void LabeledEdit::frameTick()
+{
+    // 窗口最小化、被遮挡时不会收到 hideEvent，等到重新显示出来再继续
+    if (!FrameScheduler::isExposed(this))
+    {
+        suspendAnimations();
+        if (isVisible() && window()->windowHandle())
+            window()->windowHandle()->installEventFilter(this);
+        return ;
+    }
+
+    const qint64 now = AnimationClock::now();
+    if (edit_pending && (edit_throttle < 0 || now - edit_time >= edit_throttle))
+        editTransition();
+
+    bool running = false;
+    bool changed = false; // 这一帧是否有进度改变（只用于性能计数）
+    for (int i = 0; i < AniChannelCount; i++)
+    {
+        AniSlot& slot = ani_slots[i];
+        if (!slot.running)
+            continue;
+        double t = static_cast<double>(now - slot.start_time) / slot.duration;
+#ifdef WIDGET_PERF_COUNTERS
+        const double before = channelProg(static_cast<AniChannel>(i));
+#endif
+        if (t >= 1)
+        {
+            slot.running = false;
+            TRACE_ASYNC_END("LabeledEdit", channel_names[i], reinterpret_cast<quintptr>(this) + i);
+            setChannelProg(static_cast<AniChannel>(i), slot.end);
+            finishAnimation(static_cast<AniChannel>(i));
+            changed = true;
+        }
+        else
+        {
+            setChannelProg(static_cast<AniChannel>(i), slot.start + (slot.end - slot.start) * slot.curve.valueForProgress(t));
+        }
+#ifdef WIDGET_PERF_COUNTERS
+        changed = changed || before != channelProg(static_cast<AniChannel>(i));
+#endif
+        running = running || slot.running;
+    }
+
+    // 结束回调里面可能开始了新的动画
+    for (int i = 0; i < AniChannelCount && !running; i++)
+        running = ani_slots[i].running;
+
+    // 菊花每 loading_interval 毫秒转一格
+    if (loading_running)
+    {
+        int index = static_cast<int>((now - loading_start_time) / loading_interval);
+        if (index != loading_index)
+        {
+            loading_index = index;
+            update(loadingRect());
+            changed = true;
+        }
+        running = true;
+    }
+    PERF_TICK(perf_counters, changed);
+    Q_UNUSED(changed)
+
+    if (!running && !edit_pending)
+        FrameScheduler::instance()->unsubscribe(this);
+}
+
+/**
+ * 直接调用对应进度的setter，不经过属性名与QVariant
+ */
+void LabeledEdit::setChannelProg(AniChannel channel, double x)
+{
+    switch (channel)
+    {
+    case LabelChannel:       setLabelProg(x); break;
+    case FocusChannel:       setFocusProg(qRound(x)); break;
+    case LosesChannel:       setLosesProg(qRound(x)); break;
+    case WrongChannel:       setWrongProg(qRound(x)); break;
+    case CorrectChannel:     setCorrectProg(qRound(x)); break;
+    case ShowLoadingChannel: setShowLoadingProg(qRound(x)); break;
+    case HideLoadingChannel: setHideLoadingProg(qRound(x)); break;
+    case TipChannel:         setTipProg(qRound(x)); break;
+    case MsgShowChannel:     setMsgShowProg(qRound(x)); break;
+    case MsgHideChannel:     setMsgHideProg(qRound(x)); break;
+    case AniChannelCount:    break;
+    }
+}
+
+/**
+ * 获取通道对应的当前进度
+ */
+double LabeledEdit::channelProg(AniChannel channel)
+{
+    switch (channel)
+    {
+    case LabelChannel:       return getLabelProg();
+    case FocusChannel:       return getFocusProg();
+    case LosesChannel:       return getLosesProg();
+    case WrongChannel:       return getWrongProg();
+    case CorrectChannel:     return getCorrectProg();
+    case ShowLoadingChannel: return getShowLoadingProg();
+    case HideLoadingChannel: return getHideLoadingProg();
+    case TipChannel:         return getTipProg();
+    case MsgShowChannel:     return getMsgShowProg();
+    case MsgHideChannel:     return getMsgHideProg();
+    case AniChannelCount:    break;
+    }
+    return 0;
+}
+
+/**
+ * 动画正常结束（被新目标打断的不算）
+ */
+void LabeledEdit::finishAnimation(AniChannel channel)
+{
+    switch (channel)
+    {
+    case FocusChannel:
+        loses_prog = 0;
+        break;
+    case LosesChannel:
+        if (!line_edit->hasFocus())
+            focus_prog = 0;
+        loses_prog = 0;
+        break;
+    case WrongChannel:
+        // 只显示波浪线一次
+        wrong_prog = 0;
+        wave_snapshot = QImage();
+        line_edit->setViewShowed(true);
+        update();
+        // 恢复隐藏的提示
+        if (!msg_text.isEmpty())
+            showMsg();
+        else if (entering)
+            showTip();
+        break;
+    case ShowLoadingChannel:
+        if (hide_loading_prog > 90) // 如果loading正在show然后马上hide，那么会hide先结束，然后再show结束，导致一直显示
+            show_loading_prog = 0;
+        break;
+    case HideLoadingChannel:
+        if (show_loading_prog == 100)
+            hide_loading_prog = 0;
+        show_loading_prog = 0;
+        loading_running = false;
+        break;
+    case MsgHideChannel:
+        // 只隐藏一次就清空
+        msg_hide_prog = 0;
+        msg_hiding = "";
+        break;
+    default:
+        break;
+    }
 }
 
 void LabeledEdit::setLabelProg(double x)
 {
     this->label_prog = x;
-    update();
+    update(labelRect());
 }
 
 double LabeledEdit::getLabelProg()
@@ -885,7 +1838,7 @@ double LabeledEdit::getLabelProg()
 void LabeledEdit::setFocusProg(int x)
 {
     this->focus_prog = x;
-    update();
+    update(underlineRect());
 }
 
 int LabeledEdit::getFocusProg()
@@ -896,7 +1849,7 @@ int LabeledEdit::getFocusProg()
 void LabeledEdit::setLosesProg(int x)
 {
     this->loses_prog = x;
-    update();
+    update(underlineRect());
 }
 
 int LabeledEdit::getLosesProg()
@@ -918,7 +1871,7 @@ int LabeledEdit::getWrongProg()
 void LabeledEdit::setCorrectProg(int x)
 {
     this->correct_prog = x;
-    update();
+    update(correctRect());
 }
 
 int LabeledEdit::getCorrectProg()
@@ -929,7 +1882,7 @@ int LabeledEdit::getCorrectProg()
 void LabeledEdit::setShowLoadingProg(int x)
 {
     this->show_loading_prog = x;
-    update();
+    update(loadingRect());
 }
 
 int LabeledEdit::getShowLoadingProg()
@@ -940,7 +1893,7 @@ int LabeledEdit::getShowLoadingProg()
 void LabeledEdit::setHideLoadingProg(int x)
 {
     this->hide_loading_prog = x;
-    update();
+    update(loadingRect());
 }
 
 int LabeledEdit::getHideLoadingProg()
@@ -951,7 +1904,7 @@ int LabeledEdit::getHideLoadingProg()
 void LabeledEdit::setTipProg(int x)
 {
     this->tip_prog = x;
-    update();
+    update(messageRect());
 }
 
 int LabeledEdit::getTipProg()
@@ -962,7 +1915,7 @@ int LabeledEdit::getTipProg()
 void LabeledEdit::setMsgShowProg(int x)
 {
     this->msg_show_prog = x;
-    update();
+    update(messageRect());
 }
 
 int LabeledEdit::getMsgShowProg()
@@ -973,7 +1926,7 @@ int LabeledEdit::getMsgShowProg()
 void LabeledEdit::setMsgHideProg(int x)
 {
     this->msg_hide_prog = x;
-    update();
+    update(messageRect());
 }
 
 int LabeledEdit::getMsgHideProg()
@@ -4,34 +4,48 @@
 #include <QObject>
 #include <QWidget>
 #include <QVBoxLayout>
-#include <QPropertyAnimation>
+#include <QEasingCurve>
 #include <QPainter>
 #include <QPainterPath>
 #include <QTimer>
+#include <QTextLayout>
+#include <QGlyphRun>
+#include <QWindow>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <functional>
 #include <cmath>
 #include <QDebug>
 #include "bottomlineedit.h"
+#include "validation.h"
+#include "validationrule.h"
+#include "framescheduler.h"
+#include "animationclock.h"
+#include "perfcounters.h"
+#include "tracerecorder.h"
 
-class LabeledEdit : public QWidget
+class LabeledEdit : public QWidget, public FrameClient
 {
     Q_OBJECT
-    Q_PROPERTY(double LabelProg READ getFocusProg WRITE setLabelProg)
-    Q_PROPERTY(int FocusProg READ getFocusProg WRITE setFocusProg)
-    Q_PROPERTY(int LosesProg READ getLosesProg WRITE setLosesProg)
-    Q_PROPERTY(int WrongProg READ getWrongProg WRITE setWrongProg)
-    Q_PROPERTY(int CorrectProg READ getCorrectProg WRITE setCorrectProg)
-    Q_PROPERTY(int ShowLoadingProg READ getShowLoadingProg WRITE setShowLoadingProg)
-    Q_PROPERTY(int HideLoadingProg READ getHideLoadingProg WRITE setHideLoadingProg)
-    Q_PROPERTY(int TipProg READ getTipProg WRITE setTipProg)
-    Q_PROPERTY(int MsgShowProg READ getMsgShowProg WRITE setMsgShowProg)
-    Q_PROPERTY(int MsgHideProg READ getMsgHideProg WRITE setMsgHideProg)
 public:
+    /**
+     * 错误波浪线经过时文字的绘制方式
+     */
+    enum WrongWaveMode
+    {
+        GlyphWave,    // 逐个字符绘制（默认）
+        SnapshotWave  // 开始时截图，每帧按列平移；保留 QSS 样式，耗时与内容长度无关
+    };
+
     LabeledEdit(QWidget *parent = nullptr);
     LabeledEdit(QString label, QWidget* parent = nullptr);
     LabeledEdit(QString label, QString def, QWidget* parent = nullptr);
 
     BottomLineEdit* editor();
     void adjustBlank();
+    int relayoutCount() const;
     QString text();
     void setText(QString text);
 
@@ -48,8 +62,37 @@ public:
     void showWrong(QString msg, bool autoClear = false);
     void showLoading();
     void hideLoading();
+    void setWrongWaveMode(WrongWaveMode mode);
+    void setChromeCache(bool enable);
+    void setScaledLabelAnimation(bool enable);
+
+    typedef std::function<QFuture<ValidationResult>(const QString&)> AsyncValidator;
+    typedef std::function<ValidationResult(const QString&)> Validator;
+    void setAsyncValidator(AsyncValidator validator);
+    void setValidator(Validator validator, QThreadPool* pool = nullptr);
+    AsyncValidator getValidator() const;
+    void setRule(const ValidationRule& rule);
+    void clearRule();
+    const ValidationRule* getRule() const;
+    void setValidateDelay(int ms);
+    void setEditThrottle(int ms);
+    quint64 suppressedTransitions() const;
+    void setValidationCache(QSharedPointer<ValidationCache> cache);
+    void setValidationCache(int capacity);
+    QSharedPointer<ValidationCache> getValidationCache() const;
+    void validate();
+    void cancelValidate();
+    void applyValidation(const ValidationResult& result);
 
 private:
+    void editTransition();
+    bool applyRule(const QString& text);
+    void supersedeValidation();
+    void captureWaveSnapshot();
+    void paintChrome(QPainter& painter, const QRect& dirty);
+    bool isChromeResting() const;
+    const QPixmap& getChromePixmap();
+    void updateLabelCharImages();
     void upperLabel();
     void innerLabel();
     void showTip();
@@ -59,16 +102,62 @@ private:
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
-    void paintEvent(QPaintEvent *) override;
+    void paintEvent(QPaintEvent *event) override;
     void enterEvent(QEvent *event) override;
     void leaveEvent(QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void frameTick() override;
 
 signals:
+    void validated(const QString& text, const ValidationResult& result);
 
 public slots:
 
 private:
-    QPropertyAnimation *startAnimation(QByteArray name, double start, double end, int duration, QEasingCurve curve = QEasingCurve::Linear);
+    QRect underlineRect() const;
+    QRect labelRect() const;
+    QRect messageRect() const;
+    QRect correctRect() const;
+    QRect loadingRect() const;
+
+    /**
+     * 每个动画进度对应一个通道
+     * 每个通道只有一个预先分配的动画槽
+     */
+    enum AniChannel
+    {
+        LabelChannel,
+        FocusChannel,
+        LosesChannel,
+        WrongChannel,
+        CorrectChannel,
+        ShowLoadingChannel,
+        HideLoadingChannel,
+        TipChannel,
+        MsgShowChannel,
+        MsgHideChannel,
+        AniChannelCount
+    };
+
+    struct AniSlot
+    {
+        bool running = false;
+        double start = 0;
+        double end = 0;
+        int duration = 0;      // 实际时长（毫秒）
+        qint64 start_time = 0; // 开始的时间
+        QEasingCurve curve;
+    };
+
+    qint64 aniNow() const;
+    void suspendAnimations();
+    void resumeAnimations();
+    void startAnimation(AniChannel channel, double start, double end, int duration, QEasingCurve::Type curve = QEasingCurve::Linear);
+    void setChannelProg(AniChannel channel, double x);
+    double channelProg(AniChannel channel);
+    void finishAnimation(AniChannel channel);
     void setLabelProg(double x);
     double getLabelProg();
     void setFocusProg(int x);
@@ -101,6 +190,57 @@ private:
     QString label_text;    // 标签
     QList<QPointF> label_in_poss; // 标签在输入框里面的左下角位置
     QList<QPointF> label_up_poss; // 标签在输入框上方的左下角位置
+    QList<QGlyphRun> label_in_runs; // 输入框里面的整个标签字形（整体排版，保留连字）
+    QList<QGlyphRun> label_up_runs; // 输入框上方的整个标签字形
+    QVector<int> label_clusters; // 每个字形簇（用户看到的一个字）的起始位置，最后一项是标签长度
+    QList<QList<QGlyphRun>> label_in_char_runs; // 逐字动画用的每个字形簇的字形
+    QList<QList<QGlyphRun>> label_up_char_runs;
+    QVector<qreal> label_in_advances; // 每个字符相对标签左边的偏移，最后一项是总宽度
+    QVector<qreal> label_up_advances;
+    double label_nh = 0;   // 输入框字体的高度
+    bool label_scaled = false;        // 标签动画使用缩放，不改变字号
+    QList<QImage> label_char_images;  // 输入框字号的每个字形簇
+    QPointF label_image_origin;       // 图片中基线左端的位置
+    QString label_images_text;
+    QFont label_images_font;
+    QRgb label_images_color = 0;
+    qreal label_images_dpr = 0;
+
+    QString wave_text;     // 错误波浪线中绘制的输入内容
+    QFont wave_font;
+    QVector<qreal> wave_advances; // 每个字符左边相对于内容开头的位置（整行排版得到），最后一个是总宽度
+    WrongWaveMode wrong_wave_mode = GlyphWave;
+    QImage wave_snapshot;  // 错误动画开始时的标签与输入内容
+    bool wave_label_inside = false; // 截图时标签是否在编辑框中
+
+    struct ChromeKey // 静止状态外观的所有输入
+    {
+        QSize size;
+        qreal dpr = 0;
+        QRect geom;
+        QString label;
+        QFont font;
+        QPointF label_pos;
+        QRgb grayed = 0, accent = 0;
+        bool label_up = false;
+        int focus_prog = 0, correct_prog = 0;
+        bool operator==(const ChromeKey& o) const
+        {
+            return size == o.size && dpr == o.dpr && geom == o.geom && label == o.label && font == o.font
+                    && label_pos == o.label_pos && grayed == o.grayed && accent == o.accent
+                    && label_up == o.label_up
+                    && focus_prog == o.focus_prog && correct_prog == o.correct_prog;
+        }
+    };
+    bool chrome_cache = true;  // 静止状态的下划线、勾、标签缓存为图片
+    QPixmap chrome_pixmap;
+    ChromeKey chrome_key;
+
+    bool layout_valid = false; // 布局缓存：字体、标签、输入框位置都没变时不重新计算
+    QString layout_text;
+    QFont layout_font;
+    QRect layout_geom;
+    int relayout_count = 0;
     const int label_ani_max = 4;  // 不超过这数字就使用普通的动画
 
     QString tip_text;      // 鼠标悬浮显示在下面的（有msg_text时隐藏）
@@ -112,7 +252,28 @@ private:
     QString msg_hiding; // 隐藏中的msg，用于两次msg的切换
     bool autoClearMsg = false; // 自动删除错误消息
 
-    QTimer* loading_timer = nullptr;
+    bool edit_pending = false;    // 有编辑等待在帧时钟中切换状态
+    qint64 edit_time = 0;         // 第一次编辑的时间
+    int edit_throttle = -1;       // 合并的时长（毫秒），-1 表示下一帧
+    quint64 suppressed_transitions = 0;
+
+    AsyncValidator validator;     // 编辑后自动校验
+    QTimer* validate_timer;       // 停止输入一段时间后才开始校验
+    quint64 validate_serial = 0;  // 每次编辑都增加，旧的校验结果直接丢弃
+    bool validate_loading = false; // 正在进行的校验显示了加载动画
+    QSharedPointer<ValidationCache> validation_cache; // 相同内容不重复校验
+    bool validation_cache_owned = false; // 缓存是 setValidationCache(int) 创建的，只有自己使用
+    ValidationRule rule;          // 输入规则，编辑时立即检查
+    bool rule_enabled = false;
+    bool rule_failed = false;     // 正在显示规则的错误
+
+    AniSlot ani_slots[AniChannelCount]; // 所有进度的动画，由全局帧时钟驱动
+    bool ani_suspended = false; // 看不见时暂停，时间停在 suspend_time
+    qint64 suspend_time = 0;
+
+    bool loading_running = false; // 菊花是否在转
+    qint64 loading_start_time = 0;
+    const int loading_interval = 80; // 每片花瓣的时长
     int loading_petal = 8;    // 菊花花瓣数量
     QRect loading_rect;    // 加载菊花的位置
     double loading_inner = 0; // 菊花内环半径
@@ -141,6 +302,10 @@ private:
     const int tip_duration = 400;
     const int msg_show_duration = 600;
     const int msg_hide_duration = 300;
+
+#ifdef WIDGET_PERF_COUNTERS
+    PerfCounters perf_counters{this};
+#endif
 };
 
 #endif // LABELEDEDIT_H
@@ -0,0 +1,154 @@
+#include "labelededitform.h"
+#include <QtConcurrent>
+
+LabeledEditForm::LabeledEditForm(QObject *parent) : QObject(parent)
+{
+}
+
+/**
+ * 添加需要校验的输入框
+ * @param validator 同步校验函数，在线程池中运行；为空则使用输入框自己的校验（setValidator/setAsyncValidator）
+ */
+void LabeledEditForm::addEdit(LabeledEdit *edit, LabeledEdit::Validator validator)
+{
+    Field field;
+    field.edit = edit;
+    field.validator = validator;
+    fields.append(field);
+}
+
+void LabeledEditForm::removeEdit(LabeledEdit *edit)
+{
+    for (int i = 0; i < fields.size(); i++)
+    {
+        if (fields.at(i).edit == edit)
+            fields.removeAt(i--);
+    }
+}
+
+/**
+ * 同步校验使用的线程池，默认使用全局线程池
+ */
+void LabeledEditForm::setThreadPool(QThreadPool *pool)
+{
+    this->pool = pool;
+}
+
+bool LabeledEditForm::isValidating() const
+{
+    return pending > 0;
+}
+
+/**
+ * 上一次提交中错误的输入框
+ */
+QList<LabeledEdit *> LabeledEditForm::invalidEdits() const
+{
+    QList<LabeledEdit*> edits;
+    for (const Field& field : fields)
+    {
+        if (!field.valid && !field.edit.isNull())
+            edits.append(field.edit);
+    }
+    return edits;
+}
+
+/**
+ * 提交：所有输入框同时开始校验
+ * 全部完成后再一起显示结果
+ */
+void LabeledEditForm::submit()
+{
+    const quint64 serial = ++submit_serial;
+    QThreadPool* thread_pool = pool ? pool : QThreadPool::globalInstance();
+    pending = 0;
+    for (int i = 0; i < fields.size(); i++)
+    {
+        Field& field = fields[i];
+        field.valid = true;
+        field.submitted = false;
+        field.future = QFuture<ValidationResult>();
+        if (field.edit.isNull())
+            continue;
+        field.edit->cancelValidate(); // 输入框自己的校验不需要了
+        field.text = field.edit->text();
+
+        // 输入规则在当前线程直接检查，不符合的不需要再校验
+        const ValidationRule* rule = field.edit->getRule();
+        ValidationResult rule_result = rule ? rule->check(field.text) : ValidationResult(true);
+        if (!rule_result.valid || (rule && !field.validator && !field.edit->getValidator()))
+        {
+            QFutureInterface<ValidationResult> ready(QFutureInterfaceBase::Started);
+            ready.reportFinished(&rule_result);
+            field.future = ready.future();
+        }
+        else if (field.validator)
+        {
+            const LabeledEdit::Validator validator = field.validator;
+            const QString text = field.text;
+            field.future = QtConcurrent::run(thread_pool, [=]{
+                return validator(text);
+            });
+        }
+        else if (field.edit->getValidator())
+        {
+            field.future = field.edit->getValidator()(field.text);
+        }
+        else
+        {
+            continue;
+        }
+
+        pending++;
+        field.submitted = true;
+        QFutureWatcher<ValidationResult>* watcher = new QFutureWatcher<ValidationResult>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [=]{
+            watcher->deleteLater();
+            if (serial != submit_serial) // 重新提交或者取消了
+                return ;
+            if (--pending == 0)
+                applyResults();
+        });
+        watcher->setFuture(field.future);
+    }
+
+    if (!pending) // 没有需要校验的
+        applyResults();
+}
+
+/**
+ * 丢弃进行中的校验
+ */
+void LabeledEditForm::cancel()
+{
+    submit_serial++;
+    pending = 0;
+}
+
+/**
+ * 一次性显示所有结果
+ * 在同一次事件循环中设置完，所有 update() 由 Qt 合并为每个控件一次重绘；所有动画同一帧开始
+ */
+void LabeledEditForm::applyResults()
+{
+    bool all_valid = true;
+    for (int i = 0; i < fields.size(); i++)
+    {
+        Field& field = fields[i];
+        if (field.edit.isNull() || !field.submitted) // 已移除，或者不需要校验
+            continue;
+        if (field.future.resultCount() == 0 || field.edit->text() != field.text)
+        {
+            // 校验被取消，或者校验期间又修改了：当前内容没有校验过，不能算作通过
+            field.valid = false;
+            all_valid = false;
+            continue;
+        }
+        ValidationResult result = field.future.result();
+        field.valid = result.valid;
+        all_valid = all_valid && result.valid;
+        field.edit->applyValidation(result);
+    }
+
+    emit finished(all_valid);
+}
@@ -0,0 +1,53 @@
+#ifndef LABELEDEDITFORM_H
+#define LABELEDEDITFORM_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include "labelededit.h"
+
+/**
+ * 整个表单的校验
+ * 提交时所有输入框同时在线程池中校验，全部完成后一次性显示结果（只重绘一次）
+ */
+class LabeledEditForm : public QObject
+{
+    Q_OBJECT
+public:
+    LabeledEditForm(QObject* parent = nullptr);
+
+    void addEdit(LabeledEdit* edit, LabeledEdit::Validator validator = nullptr);
+    void removeEdit(LabeledEdit* edit);
+    void setThreadPool(QThreadPool* pool);
+    bool isValidating() const;
+    QList<LabeledEdit*> invalidEdits() const;
+
+signals:
+    void finished(bool valid); // 所有结果都已经显示
+
+public slots:
+    void submit();
+    void cancel();
+
+private:
+    void applyResults();
+
+private:
+    struct Field
+    {
+        QPointer<LabeledEdit> edit;
+        LabeledEdit::Validator validator; // 为空则使用输入框自己的校验
+        QString text;                     // 提交时的内容
+        QFuture<ValidationResult> future;
+        bool valid = true;
+        bool submitted = false;           // 这次提交中是否需要校验
+    };
+
+    QList<Field> fields;
+    QThreadPool* pool = nullptr;
+    quint64 submit_serial = 0; // 重新提交、取消后，之前的结果直接丢弃
+    int pending = 0;           // 还没有完成的数量
+};
+
+#endif // LABELEDEDITFORM_H
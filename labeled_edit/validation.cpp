@@ -0,0 +1,54 @@
+#include "validation.h"
+
+/**
+ * @param capacity 最多缓存多少个不同的输入内容
+ */
+ValidationCache::ValidationCache(int capacity) : cache(qMax(1, capacity))
+{
+}
+
+/**
+ * 查找缓存的结果，找到的会变成最近使用的
+ * @return 是否找到
+ */
+bool ValidationCache::find(const QString &text, ValidationResult *result)
+{
+    ValidationResult* cached = cache.object(text);
+    if (!cached)
+    {
+        misses++;
+        return false;
+    }
+    hits++;
+    if (result)
+        *result = *cached;
+    return true;
+}
+
+void ValidationCache::insert(const QString &text, const ValidationResult &result)
+{
+    cache.insert(text, new ValidationResult(result));
+}
+
+/**
+ * 校验规则改变后需要清空
+ */
+void ValidationCache::clear()
+{
+    cache.clear();
+}
+
+void ValidationCache::setCapacity(int capacity)
+{
+    cache.setMaxCost(qMax(1, capacity));
+}
+
+int ValidationCache::capacity() const
+{
+    return cache.maxCost();
+}
+
+int ValidationCache::size() const
+{
+    return cache.size();
+}
@@ -0,0 +1,46 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include <QString>
+#include <QCache>
+#include <QMetaType>
+
+/**
+ * 输入内容的校验结果
+ */
+struct ValidationResult
+{
+    ValidationResult(bool valid = true, QString message = QString()) : valid(valid), message(message) {}
+
+    bool valid;      // 是否正确
+    QString message; // 错误时显示的信息，为空则只显示波浪线
+};
+Q_DECLARE_METATYPE(ValidationResult)
+
+/**
+ * 校验结果缓存（按输入内容，最近最少使用的先淘汰）
+ * 相同规则的多个输入框可以通过 QSharedPointer 共用一个
+ * 只在界面线程中使用
+ */
+class ValidationCache
+{
+public:
+    ValidationCache(int capacity = 128);
+
+    bool find(const QString& text, ValidationResult* result);
+    void insert(const QString& text, const ValidationResult& result);
+    void clear();
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    int size() const;
+    quint64 hitCount() const { return hits; }
+    quint64 missCount() const { return misses; }
+
+private:
+    QCache<QString, ValidationResult> cache;
+    quint64 hits = 0;
+    quint64 misses = 0;
+};
+
+#endif // VALIDATION_H
@@ -0,0 +1,255 @@
+#include "validationrule.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VALIDATIONRULE_SSE2
+#endif
+
+ValidationRule::ValidationRule()
+{
+    messages[Empty] = "不能为空";
+    messages[TooShort] = "至少%1个字符";
+    messages[TooLong] = "最多%1个字符";
+    messages[InvalidChar] = "不能包含“%1”";
+    messages[MissingClass] = "必须包含%1";
+    messages[Forbidden] = "不能包含“%1”";
+    compile();
+}
+
+/**
+ * 长度范围（按字符数）
+ * @param max -1 表示不限
+ */
+ValidationRule &ValidationRule::setLength(int min, int max)
+{
+    min_length = qMax(0, min);
+    max_length = max;
+    return *this;
+}
+
+/**
+ * 允许出现的字符种类，默认全部允许
+ */
+ValidationRule &ValidationRule::setAllowed(CharClasses classes)
+{
+    allowed = classes;
+    compile();
+    return *this;
+}
+
+/**
+ * 每一种都必须至少出现一次，例如密码必须包含大写字母和数字
+ */
+ValidationRule &ValidationRule::setRequired(CharClasses classes)
+{
+    required = classes;
+    return *this;
+}
+
+/**
+ * 禁止出现的文字
+ */
+ValidationRule &ValidationRule::addForbidden(const QString &text, Qt::CaseSensitivity cs)
+{
+    if (text.isEmpty())
+        return *this;
+    forbidden.append(text);
+    forbidden_matchers.append(QStringMatcher(text, cs));
+    return *this;
+}
+
+/**
+ * 自定义错误信息，%1 的含义见 Failure
+ */
+ValidationRule &ValidationRule::setMessage(Failure failure, const QString &message)
+{
+    if (failure >= 0 && failure < FailureCount)
+        messages[failure] = message;
+    return *this;
+}
+
+/**
+ * 生成 ASCII 字符种类表与不允许的种类
+ */
+void ValidationRule::compile()
+{
+    disallowed_mask = static_cast<quint8>(~allowed & AnyChar);
+    for (int c = 0; c < 128; c++)
+    {
+        quint8 cls;
+        if (c >= 'a' && c <= 'z')
+            cls = Lower;
+        else if (c >= 'A' && c <= 'Z')
+            cls = Upper;
+        else if (c >= '0' && c <= '9')
+            cls = Digit;
+        else if (c == '_')
+            cls = Underscore;
+        else if (c == ' ' || c == '\t')
+            cls = Space;
+        else
+            cls = Symbol; // 包括控制字符
+        ascii_table[c] = cls;
+    }
+}
+
+/**
+ * 字符数，代理对（表情等）算作一个字符
+ */
+int ValidationRule::codePointCount(const ushort *data, int units)
+{
+    int count = units;
+    for (int i = 0; i + 1 < units; i++)
+    {
+        if (QChar::isHighSurrogate(data[i]) && QChar::isLowSurrogate(data[i + 1]))
+        {
+            count--;
+            i++;
+        }
+    }
+    return count;
+}
+
+/**
+ * 检查输入内容
+ * 依次检查：是否为空、长度、不允许的字符、必须包含的字符、禁止出现的文字
+ * 只有第一个不符合的会作为错误信息
+ */
+ValidationResult ValidationRule::check(const QString &text) const
+{
+    const ushort* data = text.utf16();
+    const int units = text.length(); // UTF-16 单元数
+    const int length = codePointCount(data, units); // 字符数：代理对算作一个字符
+    if (length == 0 && min_length > 0)
+        return ValidationResult(false, messages[Empty]);
+    if (length < min_length)
+        return ValidationResult(false, messages[TooShort].arg(min_length));
+    if (max_length >= 0 && length > max_length)
+        return ValidationResult(false, messages[TooLong].arg(max_length));
+
+    // ==== 扫描出现过的字符种类 ====
+    const quint8 disallowed = disallowed_mask;
+    quint8 seen = 0;
+    int i = 0;
+#ifdef VALIDATIONRULE_SSE2
+    // 每次8个字符，用范围比较同时得到每一种字符是否出现
+    // 有符号比较：0x8000 以上的字符是负数，不会落在任何 ASCII 范围内
+    const __m128i high_mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    auto inRange = [](__m128i v, short lo, short hi) {
+        return _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(static_cast<short>(lo - 1))),
+                             _mm_cmplt_epi16(v, _mm_set1_epi16(static_cast<short>(hi + 1))));
+    };
+    for (; i + 8 <= units && !(seen & disallowed); i += 8)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(chunk, high_mask), zero);
+        const __m128i lower = inRange(chunk, 'a', 'z');
+        const __m128i upper = inRange(chunk, 'A', 'Z');
+        const __m128i digit = inRange(chunk, '0', '9');
+        const __m128i underscore = _mm_cmpeq_epi16(chunk, _mm_set1_epi16('_'));
+        const __m128i space = _mm_or_si128(_mm_cmpeq_epi16(chunk, _mm_set1_epi16(' ')),
+                                           _mm_cmpeq_epi16(chunk, _mm_set1_epi16('\t')));
+        const __m128i known = _mm_or_si128(_mm_or_si128(lower, upper),
+                                           _mm_or_si128(_mm_or_si128(digit, underscore), space));
+        const __m128i symbol = _mm_andnot_si128(known, ascii); // 其他 ASCII，包括控制字符
+        if (_mm_movemask_epi8(lower))
+            seen |= Lower;
+        if (_mm_movemask_epi8(upper))
+            seen |= Upper;
+        if (_mm_movemask_epi8(digit))
+            seen |= Digit;
+        if (_mm_movemask_epi8(underscore))
+            seen |= Underscore;
+        if (_mm_movemask_epi8(space))
+            seen |= Space;
+        if (_mm_movemask_epi8(symbol))
+            seen |= Symbol;
+        if (_mm_movemask_epi8(ascii) != 0xFFFF)
+            seen |= NonAscii;
+    }
+#endif
+    for (; i < units && !(seen & disallowed); i++)
+        seen |= classOf(data[i]);
+
+    if (seen & disallowed)
+    {
+        // 找到第一个不允许的字符用于提示
+        for (int k = 0; k < units; k++)
+        {
+            if (!(classOf(data[k]) & disallowed))
+                continue;
+            int size = (QChar::isHighSurrogate(data[k]) && k + 1 < units) ? 2 : 1;
+            return ValidationResult(false, messages[InvalidChar].arg(text.mid(k, size)));
+        }
+    }
+
+    const CharClasses missing = required & ~CharClasses(QFlag(seen));
+    if (missing)
+        return ValidationResult(false, messages[MissingClass].arg(classNames(missing)));
+
+    for (int k = 0; k < forbidden_matchers.size(); k++)
+    {
+        if (forbidden_matchers.at(k).indexIn(text) >= 0)
+            return ValidationResult(false, messages[Forbidden].arg(forbidden.at(k)));
+    }
+
+    return ValidationResult(true);
+}
+
+/**
+ * 根据规则生成提示文字，可直接用于 setTipText
+ * 例如：允许大小写字母、数字、下划线，4~16位
+ */
+QString ValidationRule::tipText() const
+{
+    QStringList parts;
+    if ((allowed & AnyChar) != AnyChar)
+        parts << "允许" + classNames(allowed);
+    if (min_length > 0 && max_length >= 0)
+        parts << QString("%1~%2位").arg(min_length).arg(max_length);
+    else if (min_length > 0)
+        parts << QString("至少%1位").arg(min_length);
+    else if (max_length >= 0)
+        parts << QString("最多%1位").arg(max_length);
+    if (required)
+        parts << "必须包含" + classNames(required);
+    return parts.join("，");
+}
+
+QString ValidationRule::className(CharClass c)
+{
+    switch (c)
+    {
+    case Lower:      return "小写字母";
+    case Upper:      return "大写字母";
+    case Digit:      return "数字";
+    case Underscore: return "下划线";
+    case Space:      return "空格";
+    case Symbol:     return "符号";
+    case NonAscii:   return "中文";
+    case Letter:     return "大小写字母";
+    case AnyChar:    return "任意字符";
+    }
+    return QString();
+}
+
+/**
+ * 多个种类的名字，用顿号连接
+ */
+QString ValidationRule::classNames(CharClasses classes)
+{
+    QStringList names;
+    if (classes.testFlag(Lower) && classes.testFlag(Upper))
+        names << className(Letter);
+    else if (classes.testFlag(Lower))
+        names << className(Lower);
+    else if (classes.testFlag(Upper))
+        names << className(Upper);
+    for (CharClass c : { Digit, Underscore, Space, Symbol, NonAscii })
+    {
+        if (classes.testFlag(c))
+            names << className(c);
+    }
+    return names.join("、");
+}
@@ -0,0 +1,80 @@
+#ifndef VALIDATIONRULE_H
+#define VALIDATIONRULE_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringMatcher>
+#include <QVector>
+#include "validation.h"
+
+/**
+ * 声明式的输入规则：长度范围、允许的字符、必须包含的字符、禁止出现的文字
+ * 规则编译成查找表，每次检查只需要扫描一遍输入内容
+ *
+ * 例如“允许大小写字母、数字、下划线，4~16位”：
+ *   ValidationRule rule;
+ *   rule.setLength(4, 16).setAllowed(ValidationRule::Letter | ValidationRule::Digit | ValidationRule::Underscore);
+ */
+class ValidationRule
+{
+public:
+    enum CharClass
+    {
+        Lower      = 0x01, // 小写字母
+        Upper      = 0x02, // 大写字母
+        Digit      = 0x04, // 数字
+        Underscore = 0x08, // 下划线
+        Space      = 0x10, // 空格、制表符
+        Symbol     = 0x20, // 其他 ASCII 符号
+        NonAscii   = 0x40, // 中文等非 ASCII 字符
+        Letter     = Lower | Upper,
+        AnyChar    = 0x7F
+    };
+    Q_DECLARE_FLAGS(CharClasses, CharClass)
+
+    enum Failure
+    {
+        Empty,        // 内容为空
+        TooShort,     // %1：最小长度
+        TooLong,      // %1：最大长度
+        InvalidChar,  // %1：不允许的字符
+        MissingClass, // %1：缺少的字符种类
+        Forbidden,    // %1：禁止出现的文字
+        FailureCount
+    };
+
+    ValidationRule();
+
+    ValidationRule& setLength(int min, int max = -1);
+    ValidationRule& setAllowed(CharClasses classes);
+    ValidationRule& setRequired(CharClasses classes);
+    ValidationRule& addForbidden(const QString& text, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    ValidationRule& setMessage(Failure failure, const QString& message);
+
+    ValidationResult check(const QString& text) const;
+    QString tipText() const;
+    static QString className(CharClass c);
+
+private:
+    void compile();
+    quint8 classOf(ushort c) const { return c < 128 ? ascii_table[c] : static_cast<quint8>(NonAscii); }
+    static QString classNames(CharClasses classes);
+    static int codePointCount(const ushort* data, int units);
+
+private:
+    int min_length = 0;
+    int max_length = -1;          // -1 表示不限
+    CharClasses allowed = AnyChar;
+    CharClasses required;
+    QStringList forbidden;
+    QString messages[FailureCount];
+
+    // 编译后的查找表，修改规则时重新生成（检查时只读，可以在多个线程中同时使用）
+    quint8 ascii_table[128];  // 每个 ASCII 字符所属的种类
+    quint8 disallowed_mask;   // 不允许的种类
+    QVector<QStringMatcher> forbidden_matchers;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ValidationRule::CharClasses)
+
+#endif // VALIDATIONRULE_H
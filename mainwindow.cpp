@@ -10,6 +10,8 @@ MainWindow::MainWindow(QWidget *parent)
     ui->widget->setText("aaaaaa");
     ui->widget->setLabelText("用户名");
     ui->widget->setTipText("允许大小写字母、数字、下划线");
+    ui->widget->setRule(ValidationRule().setLength(4, 16)
+                        .setAllowed(ValidationRule::Letter | ValidationRule::Digit | ValidationRule::Underscore));
     ui->widget_2->setLabelText("密码");
     ui->widget_2->setTipText("任意文字");
     ui->widget_2->editor()->setEchoMode(QLineEdit::EchoMode::Password);